@@ -19,15 +19,24 @@
 
 #include "NIDAQmxCalibrationConfig.h"
 
+#include <cstddef>
+
 using nidaqmx::NIDAQmxCalibrationConfig;
+using nidaqmx::NIDAQmxAffineBlock;
 using nidaqmx::DoubleMatrix2D;
+using std::size_t;
 using std::vector;
 
 /* *********************************************************************************************************************** */
 /* ******* Default Constructor.                                             ********************************************** */
-NIDAQmxCalibrationConfig::NIDAQmxCalibrationConfig(const std::vector<double> &aDAQSensorCalibScales, const DoubleMatrix2D &aDAQSensorCalibMatrix) {
+NIDAQmxCalibrationConfig::NIDAQmxCalibrationConfig(const std::vector<double> &aDAQSensorCalibScales, const DoubleMatrix2D &aDAQSensorCalibMatrix,
+        const std::vector<double> &aDAQSensorBias, const DoubleMatrix2D &aDAQOutputTransform) {
     DAQSensorCalibScales = aDAQSensorCalibScales;
     DAQSensorCalibMatrix = aDAQSensorCalibMatrix;
+    DAQSensorBias = aDAQSensorBias;
+    DAQOutputTransform = aDAQOutputTransform;
+
+    composeAffine();
 }
 /* *********************************************************************************************************************** */
 
@@ -46,3 +55,195 @@ DoubleMatrix2D &NIDAQmxCalibrationConfig::getDAQSensorCalibMatrix() {
     return DAQSensorCalibMatrix;
 }
 /* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the sensor bias.                                             ********************************************** */
+vector<double> &NIDAQmxCalibrationConfig::getDAQSensorBias() {
+    return DAQSensorBias;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the output transform.                                        ********************************************** */
+DoubleMatrix2D &NIDAQmxCalibrationConfig::getDAQOutputTransform() {
+    return DAQOutputTransform;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the composed affine matrix.                                  ********************************************** */
+vector<double> &NIDAQmxCalibrationConfig::getDAQAffineMatrix() {
+    return DAQAffineMatrix;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the composed affine offset.                                  ********************************************** */
+vector<double> &NIDAQmxCalibrationConfig::getDAQAffineOffset() {
+    return DAQAffineOffset;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the number of outputs.                                       ********************************************** */
+size_t NIDAQmxCalibrationConfig::getDAQNOutputs() {
+    return DAQSensorCalibMatrix.size();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the affine matrix layout.                                    ********************************************** */
+nidaqmx::NIDAQmxAffineLayout NIDAQmxCalibrationConfig::getDAQAffineLayout() {
+    return DAQAffineLayout;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the affine matrix blocks.                                    ********************************************** */
+vector<NIDAQmxAffineBlock> &NIDAQmxCalibrationConfig::getDAQAffineBlocks() {
+    return DAQAffineBlocks;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the packed affine coefficients.                              ********************************************** */
+vector<double> &NIDAQmxCalibrationConfig::getDAQAffineCoefficients() {
+    return DAQAffineCoefficients;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the packed affine coefficient columns.                       ********************************************** */
+vector<size_t> &NIDAQmxCalibrationConfig::getDAQAffineColumns() {
+    return DAQAffineColumns;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the packed affine row starts.                                ********************************************** */
+vector<size_t> &NIDAQmxCalibrationConfig::getDAQAffineRowStarts() {
+    return DAQAffineRowStarts;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Compose the affine map.                                          ********************************************** */
+void NIDAQmxCalibrationConfig::composeAffine(void) {
+    size_t nOutputs = DAQSensorCalibMatrix.size();
+    size_t nChannels = (nOutputs > 0) ? DAQSensorCalibMatrix[0].size() : 0;
+
+    // Scaled calibration S = diag(1/scales) C
+    DoubleMatrix2D scaled(nOutputs, vector<double>(nChannels));
+    for (size_t i = 0; i < nOutputs; ++i) {
+        for (size_t j = 0; j < nChannels; ++j) {
+            scaled[i][j] = DAQSensorCalibMatrix[i][j] / DAQSensorCalibScales[i];
+        }
+    }
+
+    // A = T S and b = -T bias, with T the identity if not given
+    DAQAffineMatrix.assign(nOutputs * nChannels, 0.0);
+    DAQAffineOffset.assign(nOutputs, 0.0);
+    for (size_t i = 0; i < nOutputs; ++i) {
+        for (size_t k = 0; k < nOutputs; ++k) {
+            double t = DAQOutputTransform.empty() ? ((i == k) ? 1.0 : 0.0) : DAQOutputTransform[i][k];
+            if (t == 0.0) {
+                continue;
+            }
+
+            for (size_t j = 0; j < nChannels; ++j) {
+                DAQAffineMatrix[i * nChannels + j] += t * scaled[k][j];
+            }
+            if (!DAQSensorBias.empty()) {
+                DAQAffineOffset[i] -= t * DAQSensorBias[k];
+            }
+        }
+    }
+
+    packAffine();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Pack the affine matrix.                                          ********************************************** */
+void NIDAQmxCalibrationConfig::packAffine(void) {
+    size_t nOutputs = DAQAffineOffset.size();
+    size_t nChannels = (nOutputs > 0) ? DAQAffineMatrix.size() / nOutputs : 0;
+
+    // Span of non-zero columns of each row, empty for a zero row
+    vector<size_t> firstColumn(nOutputs, 0);
+    vector<size_t> nColumns(nOutputs, 0);
+    size_t nNonZero = 0;
+    size_t nSpanned = 0;
+    for (size_t i = 0; i < nOutputs; ++i) {
+        const double *row = &DAQAffineMatrix[i * nChannels];
+        size_t first = nChannels;
+        size_t last = 0;
+        for (size_t j = 0; j < nChannels; ++j) {
+            if (row[j] != 0.0) {
+                first = (first < j) ? first : j;
+                last = j;
+                ++nNonZero;
+            }
+        }
+        if (first < nChannels) {
+            firstColumn[i] = first;
+            nColumns[i] = last - first + 1;
+        }
+        nSpanned += nColumns[i];
+    }
+
+    DAQAffineBlocks.clear();
+    DAQAffineCoefficients.clear();
+    DAQAffineColumns.clear();
+    DAQAffineRowStarts.clear();
+
+    if (2 * nNonZero >= nSpanned) {
+        // Mostly non-zero within the row spans: group consecutive rows sharing a span into dense blocks
+        DAQAffineLayout = AffineBlocks;
+        DAQAffineCoefficients.reserve(nSpanned);
+        for (size_t i = 0; i < nOutputs; ++i) {
+            if (DAQAffineBlocks.empty() || (firstColumn[i] != DAQAffineBlocks.back().firstColumn) || (nColumns[i] != DAQAffineBlocks.back().nColumns)) {
+                NIDAQmxAffineBlock block;
+                block.firstRow = i;
+                block.nRows = 0;
+                block.firstColumn = firstColumn[i];
+                block.nColumns = nColumns[i];
+                block.offset = DAQAffineCoefficients.size();
+                DAQAffineBlocks.push_back(block);
+            }
+            ++DAQAffineBlocks.back().nRows;
+
+            const double *row = &DAQAffineMatrix[i * nChannels + firstColumn[i]];
+            DAQAffineCoefficients.insert(DAQAffineCoefficients.end(), row, row + nColumns[i]);
+        }
+    } else {
+        // Scattered coefficients: compressed sparse rows
+        DAQAffineLayout = AffineSparse;
+        DAQAffineCoefficients.reserve(nNonZero);
+        DAQAffineColumns.reserve(nNonZero);
+        DAQAffineRowStarts.reserve(nOutputs + 1);
+        for (size_t i = 0; i < nOutputs; ++i) {
+            DAQAffineRowStarts.push_back(DAQAffineCoefficients.size());
+            for (size_t j = 0; j < nChannels; ++j) {
+                if (DAQAffineMatrix[i * nChannels + j] != 0.0) {
+                    DAQAffineCoefficients.push_back(DAQAffineMatrix[i * nChannels + j]);
+                    DAQAffineColumns.push_back(j);
+                }
+            }
+        }
+        DAQAffineRowStarts.push_back(DAQAffineCoefficients.size());
+    }
+}
+/* *********************************************************************************************************************** */
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+#include "NIDAQmxChannelFactory.h"
+
+using nidaqmx::NIDAQmxChannelFactory;
+using nidaqmx::NIDAQmxChannelSpec;
+using std::map;
+using std::string;
+
+
+namespace {
+    /**
+     * Create analog voltage input channels.
+     */
+    int32 createAIVoltageChannels(TaskHandle i_taskHandle, const NIDAQmxChannelSpec &i_spec, int i_units) {
+#ifdef __linux__
+        return DAQmxBaseCreateAIVoltageChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", i_spec.terminalConfig,
+                i_spec.minVal, i_spec.maxVal, i_units, NULL);
+#elif _WIN32
+        return DAQmxCreateAIVoltageChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", i_spec.terminalConfig,
+                i_spec.minVal, i_spec.maxVal, i_units, NULL);
+#endif
+    }
+
+#ifdef _WIN32
+    /**
+     * Create analog current input channels using the device default shunt resistor.
+     * NIDAQmxBase does not provide current channels.
+     */
+    int32 createAICurrentChannels(TaskHandle i_taskHandle, const NIDAQmxChannelSpec &i_spec, int i_units) {
+        return DAQmxCreateAICurrentChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", i_spec.terminalConfig,
+                i_spec.minVal, i_spec.maxVal, i_units, DAQmx_Val_Default, 0.0, NULL);
+    }
+#endif
+
+    /**
+     * Create thermocouple input channels with built-in cold-junction compensation.
+     * Thermocouple channels have no terminal configuration.
+     */
+    int32 createAIThermocoupleChannels(TaskHandle i_taskHandle, const NIDAQmxChannelSpec &i_spec, int i_thermocoupleType) {
+#ifdef __linux__
+        return DAQmxBaseCreateAIThrmcplChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", i_spec.minVal, i_spec.maxVal,
+                nidaqmx::DAQChannelType::DegC, i_thermocoupleType, DAQmx_Val_BuiltIn, 0.0, "");
+#elif _WIN32
+        return DAQmxCreateAIThrmcplChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", i_spec.minVal, i_spec.maxVal,
+                nidaqmx::DAQChannelType::DegC, i_thermocoupleType, DAQmx_Val_BuiltIn, 0.0, "");
+#endif
+    }
+
+    /**
+     * Create an X4 quadrature angular encoder channel, without Z index, starting at zero degrees.
+     */
+    int32 createCIAngEncoderChannels(TaskHandle i_taskHandle, const NIDAQmxChannelSpec &i_spec, int i_units) {
+#ifdef __linux__
+        return DAQmxBaseCreateCIAngEncoderChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", DAQmx_Val_X4, 0, 0.0, DAQmx_Val_AHighBHigh,
+                i_units, (uInt32) i_spec.scale, 0.0, NULL);
+#elif _WIN32
+        return DAQmxCreateCIAngEncoderChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", DAQmx_Val_X4, 0, 0.0, DAQmx_Val_AHighBHigh,
+                i_units, (uInt32) i_spec.scale, 0.0, NULL);
+#endif
+    }
+
+    /**
+     * Create an X4 quadrature linear encoder channel, without Z index, starting at zero.
+     */
+    int32 createCILinEncoderChannels(TaskHandle i_taskHandle, const NIDAQmxChannelSpec &i_spec, int i_units) {
+#ifdef __linux__
+        return DAQmxBaseCreateCILinEncoderChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", DAQmx_Val_X4, 0, 0.0, DAQmx_Val_AHighBHigh,
+                i_units, i_spec.scale, 0.0, NULL);
+#elif _WIN32
+        return DAQmxCreateCILinEncoderChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", DAQmx_Val_X4, 0, 0.0, DAQmx_Val_AHighBHigh,
+                i_units, i_spec.scale, 0.0, NULL);
+#endif
+    }
+
+    /**
+     * Create a rising edge counter channel counting up from zero.
+     */
+    int32 createCICountEdgesChannels(TaskHandle i_taskHandle, const NIDAQmxChannelSpec &i_spec, int i_edge) {
+#ifdef __linux__
+        return DAQmxBaseCreateCICountEdgesChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", i_edge, 0, DAQmx_Val_CountUp);
+#elif _WIN32
+        return DAQmxCreateCICountEdgesChan(i_taskHandle, i_spec.physicalChannels.c_str(), "", i_edge, 0, DAQmx_Val_CountUp);
+#endif
+    }
+}
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default Constructor.                                             ********************************************** */
+NIDAQmxChannelFactory::NIDAQmxChannelFactory() {
+    registerChannelType("AIVoltage", createAIVoltageChannels, DAQChannelType::Volts);
+#ifdef _WIN32
+    registerChannelType("AICurrent", createAICurrentChannels, DAQChannelType::Amps);
+#endif
+
+    registerChannelType("AIThermocoupleB", createAIThermocoupleChannels, DAQmx_Val_B_Type_TC);
+    registerChannelType("AIThermocoupleE", createAIThermocoupleChannels, DAQmx_Val_E_Type_TC);
+    registerChannelType("AIThermocoupleJ", createAIThermocoupleChannels, DAQmx_Val_J_Type_TC);
+    registerChannelType("AIThermocoupleK", createAIThermocoupleChannels, DAQmx_Val_K_Type_TC);
+    registerChannelType("AIThermocoupleN", createAIThermocoupleChannels, DAQmx_Val_N_Type_TC);
+    registerChannelType("AIThermocoupleR", createAIThermocoupleChannels, DAQmx_Val_R_Type_TC);
+    registerChannelType("AIThermocoupleS", createAIThermocoupleChannels, DAQmx_Val_S_Type_TC);
+    registerChannelType("AIThermocoupleT", createAIThermocoupleChannels, DAQmx_Val_T_Type_TC);
+
+    registerChannelType("CIAngEncoder", createCIAngEncoderChannels, DAQmx_Val_Degrees, CounterInput);
+    registerChannelType("CILinEncoder", createCILinEncoderChannels, DAQmx_Val_Meters, CounterInput);
+    registerChannelType("CICountEdges", createCICountEdgesChannels, DAQmx_Val_Rising, CounterInput);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Register a channel type.                                         ********************************************** */
+void NIDAQmxChannelFactory::registerChannelType(const string &i_name, NIDAQmxChannelCreator i_creator, int i_param, NIDAQmxChannelKind i_kind) {
+    Entry entry;
+    entry.creator = i_creator;
+    entry.param = i_param;
+    entry.kind = i_kind;
+
+    channelTypes[i_name] = entry;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Check whether a channel type is registered.                      ********************************************** */
+bool NIDAQmxChannelFactory::hasChannelType(const string &i_name) const {
+    return channelTypes.find(i_name) != channelTypes.end();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the kind of a channel type.                                  ********************************************** */
+nidaqmx::NIDAQmxChannelKind NIDAQmxChannelFactory::getChannelKind(const string &i_name) const {
+    return channelTypes.find(i_name)->second.kind;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Create channels of the given type.                               ********************************************** */
+int32 NIDAQmxChannelFactory::createChannels(TaskHandle i_taskHandle, const string &i_name, const NIDAQmxChannelSpec &i_spec) const {
+    map<string, Entry>::const_iterator entry = channelTypes.find(i_name);
+
+    return entry->second.creator(i_taskHandle, i_spec, entry->second.param);
+}
+/* *********************************************************************************************************************** */
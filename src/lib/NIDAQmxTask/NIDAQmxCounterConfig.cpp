@@ -0,0 +1,57 @@
+/* 
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org 
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+#include "NIDAQmxCounterConfig.h"
+
+using nidaqmx::NIDAQmxCounterConfig;
+using std::vector;
+using std::string;
+
+/* *********************************************************************************************************************** */
+/* ******* Default Constructor.                                             ********************************************** */
+NIDAQmxCounterConfig::NIDAQmxCounterConfig(const vector<string> &aDAQCounterChannels, const vector<string> &aDAQCounterChannelTypes,
+        const vector<double> &aDAQCounterScales) {
+    DAQCounterChannels = aDAQCounterChannels;
+    DAQCounterChannelTypes = aDAQCounterChannelTypes;
+    DAQCounterScales = aDAQCounterScales;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ Counter list.                                        ********************************************** */
+vector<string> &NIDAQmxCounterConfig::getDAQCounterChannels() {
+    return DAQCounterChannels;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ Counter type list.                                   ********************************************** */
+vector<string> &NIDAQmxCounterConfig::getDAQCounterChannelTypes() {
+    return DAQCounterChannelTypes;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ Counter scales.                                      ********************************************** */
+vector<double> &NIDAQmxCounterConfig::getDAQCounterScales() {
+    return DAQCounterScales;
+}
+/* *********************************************************************************************************************** */
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+
+
+#include "NIDAQmxDeltaCodec.h"
+
+#include <stdint.h>
+
+using nidaqmx::NIDAQmxDeltaCodec;
+
+
+namespace {
+    /**
+     * The largest bit width of a zigzag mapped difference of two 16-bit values.
+     */
+    const unsigned int maxWidth = 17;
+
+    /**
+     * Get the number of bits needed by a value.
+     */
+    unsigned int bitWidth(uint32_t i_value) {
+        unsigned int width = 0;
+        while (i_value) {
+            ++width;
+            i_value >>= 1;
+        }
+
+        return width;
+    }
+
+    /**
+     * Get the number of bytes of a frame.
+     */
+    size_t frameBytes(const size_t &i_nValues, const unsigned int &i_width) {
+        return (i_nValues * i_width + 7) / 8;
+    }
+}
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the largest size of an encoded block.                        ********************************************** */
+size_t NIDAQmxDeltaCodec::maxEncodedSize(const size_t &i_nScans, const size_t &i_nChannels) {
+    size_t nFrames = (i_nScans + frameSize - 1) / frameSize;
+
+    return i_nChannels * (nFrames + frameBytes(i_nScans, maxWidth));
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Encode a block.                                                  ********************************************** */
+size_t NIDAQmxDeltaCodec::encode(const int16 *i_values, const size_t &i_nScans, const size_t &i_nChannels, unsigned char *o_bytes) {
+    unsigned char *out = o_bytes;
+    uint32_t frame[frameSize];
+
+    for (size_t j = 0; j < i_nChannels; ++j) {
+        int previous = 0;
+
+        for (size_t first = 0; first < i_nScans; first += frameSize) {
+            size_t nValues = (i_nScans - first < frameSize) ? i_nScans - first : frameSize;
+
+            // Zigzag mapped differences, and the width of the largest one
+            uint32_t bits = 0;
+            const int16 *x = i_values + first*i_nChannels + j;
+            for (size_t k = 0; k < nValues; ++k) {
+                int32_t delta = x[k*i_nChannels] - previous;
+                previous = x[k*i_nChannels];
+                frame[k] = ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31);
+                bits |= frame[k];
+            }
+            unsigned int width = bitWidth(bits);
+            *out++ = (unsigned char) width;
+
+            // Pack the frame 32 bits at a time, then the last bytes
+            uint64_t accumulator = 0;
+            unsigned int nBits = 0;
+            for (size_t k = 0; k < nValues; ++k) {
+                accumulator |= (uint64_t) frame[k] << nBits;
+                nBits += width;
+                if (nBits >= 32) {
+                    out[0] = (unsigned char) accumulator;
+                    out[1] = (unsigned char) (accumulator >> 8);
+                    out[2] = (unsigned char) (accumulator >> 16);
+                    out[3] = (unsigned char) (accumulator >> 24);
+                    out += 4;
+                    accumulator >>= 32;
+                    nBits -= 32;
+                }
+            }
+            for (; nBits > 0; nBits = (nBits > 8) ? nBits - 8 : 0) {
+                *out++ = (unsigned char) accumulator;
+                accumulator >>= 8;
+            }
+        }
+    }
+
+    return out - o_bytes;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Decode a block.                                                  ********************************************** */
+bool NIDAQmxDeltaCodec::decode(const unsigned char *i_bytes, const size_t &i_size, const size_t &i_nScans, const size_t &i_nChannels, int16 *o_values) {
+    const unsigned char *in = i_bytes;
+    const unsigned char *end = i_bytes + i_size;
+
+    for (size_t j = 0; j < i_nChannels; ++j) {
+        int previous = 0;
+
+        for (size_t first = 0; first < i_nScans; first += frameSize) {
+            size_t nValues = (i_nScans - first < frameSize) ? i_nScans - first : frameSize;
+
+            if (in >= end) {
+                return false;
+            }
+            unsigned int width = *in++;
+            if ((width > maxWidth) || (frameBytes(nValues, width) > (size_t) (end - in))) {
+                return false;
+            }
+
+            // Unpack, unmap and sum the differences
+            uint32_t mask = (1u << width) - 1;
+            uint64_t accumulator = 0;
+            unsigned int nBits = 0;
+            int16 *x = o_values + first*i_nChannels + j;
+            for (size_t k = 0; k < nValues; ++k) {
+                while (nBits < width) {
+                    accumulator |= (uint64_t) *in++ << nBits;
+                    nBits += 8;
+                }
+                uint32_t zigzag = (uint32_t) accumulator & mask;
+                accumulator >>= width;
+                nBits -= width;
+
+                previous += (int32_t) (zigzag >> 1) ^ -(int32_t) (zigzag & 1);
+                x[k*i_nChannels] = (int16) previous;
+            }
+        }
+    }
+
+    return in == end;
+}
+/* *********************************************************************************************************************** */
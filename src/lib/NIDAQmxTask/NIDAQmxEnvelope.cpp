@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+#include "NIDAQmxEnvelope.h"
+
+#include <cmath>
+
+using nidaqmx::NIDAQmxEnvelope;
+using std::vector;
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default constructor.                                             ********************************************** */
+NIDAQmxEnvelope::NIDAQmxEnvelope(const size_t &aNChannels, const size_t &aBinScans)
+    : nChannels(aNChannels)
+      , binScans(aBinScans > 0 ? aBinScans : 1)
+      , binFill(0)
+      , binMin(aNChannels)
+      , binMax(aNChannels) {
+    envelopes.reserve(16 * 2 * nChannels);
+
+    resetBin();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Process a block of sensor values.                                ********************************************** */
+void NIDAQmxEnvelope::processBlock(const vector<double> &i_values) {
+    size_t nScans = i_values.size() / nChannels;
+    double *mn = &binMin[0];
+    double *mx = &binMax[0];
+
+    for (size_t s = 0; s < nScans; ++s) {
+        const double *x = &i_values[s * nChannels];
+        for (size_t j = 0; j < nChannels; ++j) {
+            mn[j] = (x[j] < mn[j]) ? x[j] : mn[j];
+            mx[j] = (x[j] > mx[j]) ? x[j] : mx[j];
+        }
+
+        // Hand over the complete bin
+        if (++binFill == binScans) {
+            envelopes.insert(envelopes.end(), binMin.begin(), binMin.end());
+            envelopes.insert(envelopes.end(), binMax.begin(), binMax.end());
+            resetBin();
+        }
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Discard the accumulated values.                                  ********************************************** */
+void NIDAQmxEnvelope::reset(void) {
+    envelopes.clear();
+    resetBin();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Collect the complete bins.                                       ********************************************** */
+bool NIDAQmxEnvelope::popEnvelopes(vector<double> &o_envelopes) {
+    if (envelopes.empty()) {
+        return false;
+    }
+
+    o_envelopes.swap(envelopes);
+    envelopes.clear();
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the number of scans per bin.                                 ********************************************** */
+size_t NIDAQmxEnvelope::getBinScans(void) const {
+    return binScans;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the number of scans in the current bin.                      ********************************************** */
+size_t NIDAQmxEnvelope::getBinFill(void) const {
+    return binFill;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Start a new bin.                                                 ********************************************** */
+void NIDAQmxEnvelope::resetBin(void) {
+    binFill = 0;
+    for (size_t j = 0; j < nChannels; ++j) {
+        binMin[j] = HUGE_VAL;
+        binMax[j] = -HUGE_VAL;
+    }
+}
+/* *********************************************************************************************************************** */
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+
+#include "NIDAQmxEventRecorder.h"
+#include "NIDAQmxFunctions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using nidaqmx::NIDAQmxEventRecorder;
+using std::vector;
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default constructor.                                             ********************************************** */
+NIDAQmxEventRecorder::NIDAQmxEventRecorder(const size_t &aNChannels, const size_t &aPreScans, const size_t &aPostScans, const vector<double> &aThresholds)
+    : nChannels(aNChannels)
+      , preScans(aPreScans)
+      , postScans(aPostScans)
+      , thresholdBlock(aNChannels)
+      , ring(aPreScans * aNChannels, 0.0)
+      , ringHead(0)
+      , ringFill(0)
+      , snapshotPreScans(0)
+      , remainingScans(0)
+      , triggerChannel(0)
+      , capturing(false)
+      , ready(false) {
+    for (size_t j = 0; j < nChannels; ++j) {
+        thresholdBlock[j] = (aThresholds[j] > 0) ? aThresholds[j] : std::numeric_limits<double>::infinity();
+    }
+
+    snapshot.reserve((preScans + postScans) * nChannels);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Process a block of sensor values.                                ********************************************** */
+void NIDAQmxEventRecorder::processBlock(const vector<double> &i_values) {
+    size_t nScans = i_values.size() / nChannels;
+    size_t scan = 0;
+
+    while (scan < nScans) {
+        if (capturing) {
+            // Append the post-trigger scans
+            size_t n = std::min(remainingScans, nScans - scan);
+            snapshot.insert(snapshot.end(), i_values.begin() + scan * nChannels, i_values.begin() + (scan + n) * nChannels);
+            pushRing(i_values, scan, n);
+
+            scan += n;
+            remainingScans -= n;
+            if (remainingScans == 0) {
+                capturing = false;
+                ready = true;
+            }
+        } else if (ready) {
+            // Keep the history up to date until the last snapshot is collected
+            pushRing(i_values, scan, nScans - scan);
+            scan = nScans;
+        } else {
+            size_t crossing = findCrossing(i_values, scan, nScans - scan);
+            pushRing(i_values, scan, crossing - scan);
+            scan = crossing;
+
+            if (crossing < nScans) {
+                // Start the snapshot with the history, oldest scan first
+                snapshot.clear();
+                size_t oldest = (ringHead + preScans - ringFill) % std::max<size_t>(preScans, 1);
+                for (size_t i = 0; i < ringFill; ++i) {
+                    size_t slot = ((oldest + i) % preScans) * nChannels;
+                    snapshot.insert(snapshot.end(), ring.begin() + slot, ring.begin() + slot + nChannels);
+                }
+                snapshotPreScans = ringFill;
+
+                triggerChannel = 0;
+                while ((triggerChannel < nChannels) && !(std::fabs(i_values[crossing * nChannels + triggerChannel]) > thresholdBlock[triggerChannel])) {
+                    ++triggerChannel;
+                }
+
+                remainingScans = postScans;
+                capturing = true;
+                if (remainingScans == 0) {
+                    capturing = false;
+                    ready = true;
+                }
+            }
+        }
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Discard the accumulated values.                                  ********************************************** */
+void NIDAQmxEventRecorder::reset(void) {
+    ringHead = 0;
+    ringFill = 0;
+    remainingScans = 0;
+    capturing = false;
+    ready = false;
+    snapshot.clear();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Collect a complete snapshot.                                     ********************************************** */
+bool NIDAQmxEventRecorder::popSnapshot(vector<double> &o_scans, size_t &o_preScans, size_t &o_triggerChannel) {
+    if (!ready) {
+        return false;
+    }
+
+    o_scans.swap(snapshot);
+    o_preScans = snapshotPreScans;
+    o_triggerChannel = triggerChannel;
+    ready = false;
+
+    // Only allocates if the caller passed a smaller vector
+    snapshot.reserve((preScans + postScans) * nChannels);
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Find the first scan crossing a threshold.                        ********************************************** */
+size_t NIDAQmxEventRecorder::findCrossing(const vector<double> &i_values, const size_t &i_first, const size_t &i_nScans) {
+    size_t nValues = i_nScans * nChannels;
+    if (nValues == 0) {
+        return i_first;
+    }
+
+    repeatChannelValues(thresholdBlock, nChannels, nValues);
+
+    // Branch-free count of the values above threshold over the whole block
+    // A double count is used as GCC does not vectorise an integer reduction of double comparisons
+    const double *values = &i_values[i_first * nChannels];
+    const double *thresholds = &thresholdBlock[0];
+    double nCrossed = 0.0;
+    for (size_t i = 0; i < nValues; ++i) {
+        nCrossed += (std::fabs(values[i]) > thresholds[i]) ? 1.0 : 0.0;
+    }
+    if (nCrossed == 0.0) {
+        return i_first + i_nScans;
+    }
+
+    // Locate the crossing scan
+    for (size_t i = 0; i < nValues; ++i) {
+        if (std::fabs(values[i]) > thresholds[i]) {
+            return i_first + i / nChannels;
+        }
+    }
+
+    return i_first + i_nScans;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Push scans into the pre-trigger ring.                            ********************************************** */
+void NIDAQmxEventRecorder::pushRing(const vector<double> &i_values, const size_t &i_first, const size_t &i_nScans) {
+    if (preScans == 0) {
+        return;
+    }
+
+    // Only the last preScans scans can survive
+    size_t skip = (i_nScans > preScans) ? (i_nScans - preScans) : 0;
+    for (size_t s = i_first + skip; s < i_first + i_nScans; ++s) {
+        std::copy(i_values.begin() + s * nChannels, i_values.begin() + (s + 1) * nChannels, ring.begin() + ringHead * nChannels);
+        ringHead = (ringHead + 1) % preScans;
+    }
+    ringFill = std::min(preScans, ringFill + i_nScans);
+}
+/* *********************************************************************************************************************** */
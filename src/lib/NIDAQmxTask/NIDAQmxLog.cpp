@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+#include "NIDAQmxLog.h"
+#include "NIDAQmxFunctions.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <thread>
+
+using nidaqmx::NIDAQmxLog;
+using nidaqmx::NIDAQmxLogLimiter;
+using nidaqmx::monotonicNow;
+using std::string;
+
+
+namespace {
+    /**
+     * The current verbosity level.
+     */
+    std::atomic<int> logLevel(NIDAQmxLog::Info);
+
+    /**
+     * The asynchronous log sink.
+     * Producers claim a slot of a bounded multi-producer queue with a compare-and-swap on the enqueue position,
+     * then publish it through the slot sequence number. A single background thread writes the published slots in order.
+     */
+    class NIDAQmxLogSink {
+        private:
+            /**
+             * The number of queue slots, a power of two.
+             */
+            static const size_t nSlots = 1024;
+
+            /**
+             * The maximum message length, including the terminator.
+             */
+            static const size_t messageLength = 256;
+
+            /**
+             * A queue slot.
+             */
+            struct Slot {
+                std::atomic<size_t> sequence;
+                int level;
+                char message[messageLength];
+            };
+
+            Slot slots[nSlots];
+            std::atomic<size_t> enqueuePos;
+            size_t dequeuePos;
+            std::atomic<size_t> writtenPos;
+            std::atomic<unsigned int> dropped;
+            std::atomic<bool> stopping;
+            std::thread writer;
+
+            /**
+             * Write the published messages, returning the number written.
+             */
+            size_t drain(void) {
+                size_t written = 0;
+
+                for (;;) {
+                    Slot &slot = slots[dequeuePos & (nSlots - 1)];
+                    if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+                        break;
+                    }
+
+                    FILE *stream = (slot.level <= NIDAQmxLog::Warning) ? stderr : stdout;
+                    fputs(slot.message, stream);
+                    fputc('\n', stream);
+
+                    slot.sequence.store(dequeuePos + nSlots, std::memory_order_release);
+                    ++dequeuePos;
+                    ++written;
+                }
+                writtenPos.store(dequeuePos, std::memory_order_release);
+
+                unsigned int nDropped = dropped.exchange(0, std::memory_order_relaxed);
+                if (nDropped > 0) {
+                    fprintf(stderr, "NIDAQmxLog: %u messages dropped. \n", nDropped);
+                }
+
+                if (written > 0) {
+                    fflush(stdout);
+                }
+
+                return written;
+            }
+
+            /**
+             * The background writer loop.
+             */
+            void run(void) {
+                while (!stopping.load(std::memory_order_acquire)) {
+                    if (drain() == 0) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    }
+                }
+                drain();
+            }
+
+        public:
+            NIDAQmxLogSink() : enqueuePos(0), dequeuePos(0), writtenPos(0), dropped(0), stopping(false) {
+                for (size_t i = 0; i < nSlots; ++i) {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                writer = std::thread(&NIDAQmxLogSink::run, this);
+            }
+
+            ~NIDAQmxLogSink() {
+                stopping.store(true, std::memory_order_release);
+                writer.join();
+            }
+
+            /**
+             * Queue a formatted message, dropping it if the queue is full.
+             */
+            void push(int i_level, const char *i_format, va_list i_args) {
+                size_t pos = enqueuePos.load(std::memory_order_relaxed);
+                Slot *slot;
+
+                for (;;) {
+                    slot = &slots[pos & (nSlots - 1)];
+                    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+
+                    if (sequence == pos) {              // Free slot, try to claim it
+                        if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    } else if (sequence < pos) {        // Queue full
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    } else {                            // Another producer claimed it
+                        pos = enqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+
+                slot->level = i_level;
+                vsnprintf(slot->message, messageLength, i_format, i_args);
+                slot->sequence.store(pos + 1, std::memory_order_release);
+            }
+
+            /**
+             * Wait until the writer has caught up with the messages queued so far.
+             */
+            void flush(void) {
+                size_t target = enqueuePos.load(std::memory_order_acquire);
+                while (writtenPos.load(std::memory_order_acquire) < target) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+    };
+
+    /**
+     * Get the process-wide sink, started on first use.
+     */
+    NIDAQmxLogSink &logSink(void) {
+        static NIDAQmxLogSink sink;
+        return sink;
+    }
+}
+
+
+/* *********************************************************************************************************************** */
+/* ******* Set the verbosity level.                                         ********************************************** */
+void NIDAQmxLog::setLevel(Level i_level) {
+    logLevel.store(i_level, std::memory_order_relaxed);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Set the verbosity level from its name.                           ********************************************** */
+bool NIDAQmxLog::setLevel(const string &i_level) {
+    if (i_level == "error") {
+        setLevel(Error);
+    } else if (i_level == "warning") {
+        setLevel(Warning);
+    } else if (i_level == "info") {
+        setLevel(Info);
+    } else if (i_level == "debug") {
+        setLevel(Debug);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Check whether a level is written.                                ********************************************** */
+bool NIDAQmxLog::isEnabled(Level i_level) {
+    return i_level <= logLevel.load(std::memory_order_relaxed);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Queue a message.                                                 ********************************************** */
+void NIDAQmxLog::log(Level i_level, const char *i_format, ...) {
+    if (!isEnabled(i_level)) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, i_format);
+    logSink().push(i_level, i_format, args);
+    va_end(args);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Write all queued messages.                                       ********************************************** */
+void NIDAQmxLog::flush(void) {
+    logSink().flush();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Rate limiter constructor.                                        ********************************************** */
+NIDAQmxLogLimiter::NIDAQmxLogLimiter(const double &aMinInterval) {
+    minInterval = aMinInterval;
+    lastTime = -aMinInterval;
+    suppressed = 0;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Check whether a message may be logged.                           ********************************************** */
+bool NIDAQmxLogLimiter::allow(unsigned int &o_suppressed) {
+    double now = monotonicNow();
+
+    if (now - lastTime >= minInterval) {
+        lastTime = now;
+        o_suppressed = suppressed;
+        suppressed = 0;
+
+        return true;
+    } else {
+        ++suppressed;
+
+        return false;
+    }
+}
+/* *********************************************************************************************************************** */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+
+
+#include "NIDAQmxQuantiser.h"
+
+#include <algorithm>
+
+using nidaqmx::NIDAQmxQuantiser;
+using std::vector;
+
+
+namespace {
+    /**
+     * The largest quantised magnitude, keeping the range symmetric.
+     */
+    const double quantisedMax = 32767.0;
+}
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default constructor.                                             ********************************************** */
+NIDAQmxQuantiser::NIDAQmxQuantiser(const vector<double> &aMin, const vector<double> &aMax) : nChannels(aMin.size()) {
+    setRanges(aMin, aMax);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Change the channel ranges.                                       ********************************************** */
+void NIDAQmxQuantiser::setRanges(const vector<double> &i_min, const vector<double> &i_max) {
+    nChannels = i_min.size();
+    scales.resize(nChannels);
+    offsets.resize(nChannels);
+
+    for (size_t j = 0; j < nChannels; ++j) {
+        offsets[j] = 0.5 * (i_min[j] + i_max[j]);
+        scales[j] = (i_max[j] > i_min[j]) ? (i_max[j] - i_min[j]) / (2 * quantisedMax) : 1.0;
+    }
+
+    // Rebuilt for the new ranges on the next block
+    blockOffsets.clear();
+    blockInvScales.clear();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Quantise a block of values.                                      ********************************************** */
+void NIDAQmxQuantiser::quantise(const vector<double> &i_values, int16 *o_values) {
+    size_t nValues = i_values.size();
+
+    // Repeat the channel parameters over the block, so that the loop below runs over flat arrays
+    if (blockOffsets.size() < nValues) {
+        size_t nScans = (nValues + nChannels - 1) / nChannels;
+        blockOffsets.resize(nScans * nChannels);
+        blockInvScales.resize(nScans * nChannels);
+        for (size_t i = 0; i < blockOffsets.size(); ++i) {
+            blockOffsets[i] = offsets[i % nChannels];
+            blockInvScales[i] = 1.0 / scales[i % nChannels];
+        }
+    }
+
+    const double *x = nValues > 0 ? &i_values[0] : NULL;
+    const double *offset = nValues > 0 ? &blockOffsets[0] : NULL;
+    const double *invScale = nValues > 0 ? &blockInvScales[0] : NULL;
+    for (size_t i = 0; i < nValues; ++i) {
+        double q = (x[i] - offset[i]) * invScale[i];
+        // Shifted to positive values so that the truncation rounds to the nearest, then clamped with plain selects:
+        // GCC vectorises neither std::min and std::max nor a clamp before the shift
+        q += quantisedMax + 0.5;
+        q = (q < 0.5) ? 0.5 : q;
+        q = (q > 2 * quantisedMax + 0.5) ? 2 * quantisedMax + 0.5 : q;
+        o_values[i] = (int16) ((int) q - (int) quantisedMax);
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the scales.                                                  ********************************************** */
+vector<double> &NIDAQmxQuantiser::getScales(void) {
+    return scales;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the offsets.                                                 ********************************************** */
+vector<double> &NIDAQmxQuantiser::getOffsets(void) {
+    return offsets;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Compute the ranges of an affine map.                             ********************************************** */
+void NIDAQmxQuantiser::affineRanges(const vector<double> &i_matrix, const vector<double> &i_offset,
+        const vector<double> &i_min, const vector<double> &i_max, vector<double> &o_min, vector<double> &o_max) {
+    size_t nOutputs = i_offset.size();
+    size_t nInputs = i_min.size();
+
+    // Each input contributes its extreme values independently
+    o_min.assign(i_offset.begin(), i_offset.end());
+    o_max.assign(i_offset.begin(), i_offset.end());
+    for (size_t i = 0; i < nOutputs; ++i) {
+        for (size_t j = 0; j < nInputs; ++j) {
+            double a = i_matrix[i*nInputs + j];
+            o_min[i] += std::min(a * i_min[j], a * i_max[j]);
+            o_max[i] += std::max(a * i_min[j], a * i_max[j]);
+        }
+    }
+}
+/* *********************************************************************************************************************** */
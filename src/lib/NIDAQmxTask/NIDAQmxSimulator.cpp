@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+#include "NIDAQmxSimulator.h"
+#include "NIDAQmxFunctions.h"
+
+#include <algorithm>
+#include <cmath>
+
+using nidaqmx::NIDAQmxSimulator;
+using nidaqmx::monotonicNow;
+using std::vector;
+
+
+namespace {
+    const double pi = 3.14159265358979323846;
+}
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default Constructor.                                             ********************************************** */
+NIDAQmxSimulator::NIDAQmxSimulator(const vector<double> &aMinVals, const vector<double> &aMaxVals) {
+    size_t nChannels = std::min(aMinVals.size(), aMaxVals.size());
+
+    // Half of the range is covered by the sine and a hundredth by the noise
+    centres.resize(nChannels);
+    amplitudes.resize(nChannels);
+    noiseAmplitudes.resize(nChannels);
+    frequencies.resize(nChannels);
+    for (size_t i = 0; i < nChannels; ++i) {
+        double range = aMaxVals[i] - aMinVals[i];
+        centres[i] = 0.5 * (aMinVals[i] + aMaxVals[i]);
+        amplitudes[i] = 0.25 * range;
+        noiseAmplitudes[i] = 0.01 * range;
+        frequencies[i] = 1.0 + 0.5 * i;
+    }
+
+    samplingRate = 0;
+    bufferSize = 0;
+    running = false;
+    startTime = 0;
+    scansRead = 0;
+    noiseState = 2463534242u;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Start acquiring.                                                 ********************************************** */
+void NIDAQmxSimulator::start(const double &i_samplingRate, const int &i_bufferSize) {
+    samplingRate = i_samplingRate;
+    bufferSize = (uInt64) std::max(i_bufferSize, 1);
+    startTime = monotonicNow();
+    scansRead = 0;
+    running = true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Stop acquiring.                                                  ********************************************** */
+void NIDAQmxSimulator::stop(void) {
+    running = false;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the number of scans available.                               ********************************************** */
+uInt64 NIDAQmxSimulator::getAvailableScans(void) const {
+    if (!running) {
+        return 0;
+    }
+
+    uInt64 scansAcquired = (uInt64) ((monotonicNow() - startTime) * samplingRate);
+
+    return scansAcquired - scansRead;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Read the scans available.                                        ********************************************** */
+bool NIDAQmxSimulator::read(const int &i_maxScans, double *o_data, int32 &o_readScans) {
+    uInt64 available = getAvailableScans();
+
+    o_readScans = 0;
+    if (available > bufferSize) {       // The oldest scans were overwritten
+        return false;
+    }
+
+    size_t nChannels = centres.size();
+    uInt64 nScans = std::min(available, (uInt64) std::max(i_maxScans, 0));
+    for (uInt64 s = 0; s < nScans; ++s) {
+        double t = (scansRead + s) / samplingRate;
+        for (size_t j = 0; j < nChannels; ++j) {
+            // Xorshift noise, uniform in [-1, 1)
+            noiseState ^= noiseState << 13;
+            noiseState ^= noiseState >> 17;
+            noiseState ^= noiseState << 5;
+            double noise = noiseState * (2.0 / 4294967296.0) - 1.0;
+
+            o_data[s * nChannels + j] = centres[j] + amplitudes[j] * std::sin(2 * pi * frequencies[j] * t) + noiseAmplitudes[j] * noise;
+        }
+    }
+    scansRead += nScans;
+    o_readScans = (int32) nScans;
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the counter values.                                          ********************************************** */
+void NIDAQmxSimulator::readCounters(const int &i_nScans, const size_t &i_nCounters, vector<double> &o_counter) const {
+    uInt64 firstScan = scansRead - i_nScans;
+
+    o_counter.resize(i_nScans * i_nCounters);
+    for (int s = 0; s < i_nScans; ++s) {
+        for (size_t c = 0; c < i_nCounters; ++c) {
+            o_counter[s * i_nCounters + c] = (double) ((firstScan + s) * (c + 1));
+        }
+    }
+}
+/* *********************************************************************************************************************** */
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+
+#include "NIDAQmxSpectrum.h"
+
+#include <algorithm>
+#include <cmath>
+
+using nidaqmx::NIDAQmxSpectrum;
+using std::vector;
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default constructor.                                             ********************************************** */
+NIDAQmxSpectrum::NIDAQmxSpectrum(const size_t &aNChannels, const size_t &aFFTSize, const size_t &aNAverages, const double &aSamplingRate,
+        const vector<double> &aBands)
+    : nChannels(aNChannels)
+      , fftSize(2)
+      , nAverages(aNAverages > 0 ? aNAverages : 1)
+      , samplingRate(aSamplingRate)
+      , historyFill(0)
+      , segments(0)
+      , ready(false) {
+    const double pi = 3.14159265358979323846;
+
+    // Round the FFT length up to a power of two
+    size_t log2Size = 1;
+    while (fftSize < aFFTSize) {
+        fftSize <<= 1;
+        ++log2Size;
+    }
+    hopSize = fftSize / 2;
+    size_t nBins = fftSize / 2 + 1;
+
+    // Hann window and density scale
+    window.resize(fftSize);
+    double windowPower = 0.0;
+    for (size_t i = 0; i < fftSize; ++i) {
+        window[i] = 0.5 - 0.5 * std::cos(2.0 * pi * i / fftSize);
+        windowPower += window[i] * window[i];
+    }
+    psdScale = 1.0 / (samplingRate * windowPower);
+
+    // Twiddle factors and bit-reversal permutation
+    twiddleRe.resize(fftSize / 2);
+    twiddleIm.resize(fftSize / 2);
+    for (size_t k = 0; k < fftSize / 2; ++k) {
+        twiddleRe[k] = std::cos(2.0 * pi * k / fftSize);
+        twiddleIm[k] = -std::sin(2.0 * pi * k / fftSize);
+    }
+    bitReversed.resize(fftSize);
+    for (size_t i = 0; i < fftSize; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < log2Size; ++b) {
+            r |= ((i >> b) & 1) << (log2Size - 1 - b);
+        }
+        bitReversed[i] = r;
+    }
+
+    // Band edges in bins
+    double binWidth = samplingRate / fftSize;
+    size_t nBands = aBands.size() / 2;
+    bandBins.resize(2 * nBands);
+    for (size_t b = 0; b < nBands; ++b) {
+        bandBins[2*b] = std::min(nBins, (size_t) std::ceil(aBands[2*b] / binWidth));
+        bandBins[2*b + 1] = std::min(nBins, (size_t) std::ceil(aBands[2*b + 1] / binWidth));
+    }
+
+    workRe.resize(fftSize);
+    workIm.resize(fftSize);
+    history.resize(nChannels * fftSize);
+    powerSum.assign(nChannels * nBins, 0.0);
+    bandEnergies.assign(nChannels * nBands, 0.0);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Process a block of sensor values.                                ********************************************** */
+void NIDAQmxSpectrum::processBlock(const vector<double> &i_values) {
+    size_t nScans = i_values.size() / nChannels;
+    size_t scan = 0;
+
+    while (scan < nScans) {
+        // De-interleave into the per-channel history
+        size_t n = std::min(fftSize - historyFill, nScans - scan);
+        for (size_t j = 0; j < nChannels; ++j) {
+            double *channelHistory = &history[j * fftSize + historyFill];
+            for (size_t s = 0; s < n; ++s) {
+                channelHistory[s] = i_values[(scan + s) * nChannels + j];
+            }
+        }
+        historyFill += n;
+        scan += n;
+
+        if (historyFill < fftSize) {
+            break;
+        }
+
+        // A full segment is available
+        for (size_t j = 0; j < nChannels; ++j) {
+            accumulateSegment(j);
+
+            // Keep the overlapping half for the next segment
+            std::copy(history.begin() + j * fftSize + hopSize, history.begin() + (j + 1) * fftSize, history.begin() + j * fftSize);
+        }
+        historyFill = fftSize - hopSize;
+        ++segments;
+
+        if (segments == nAverages) {
+            // Integrate the averaged one-sided density over each band
+            size_t nBins = fftSize / 2 + 1;
+            size_t nBands = bandBins.size() / 2;
+            double binWidth = samplingRate / fftSize;
+            for (size_t j = 0; j < nChannels; ++j) {
+                const double *power = &powerSum[j * nBins];
+                for (size_t b = 0; b < nBands; ++b) {
+                    double energy = 0.0;
+                    for (size_t k = bandBins[2*b]; k < bandBins[2*b + 1]; ++k) {
+                        // DC and Nyquist bins have no negative-frequency image
+                        double oneSided = ((k == 0) || (k == nBins - 1)) ? 1.0 : 2.0;
+                        energy += oneSided * power[k];
+                    }
+                    bandEnergies[j * nBands + b] = energy * psdScale * binWidth / segments;
+                }
+            }
+
+            std::fill(powerSum.begin(), powerSum.end(), 0.0);
+            segments = 0;
+            ready = true;
+        }
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Discard the accumulated values.                                  ********************************************** */
+void NIDAQmxSpectrum::reset(void) {
+    historyFill = 0;
+    segments = 0;
+    std::fill(powerSum.begin(), powerSum.end(), 0.0);
+    ready = false;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Collect the band energies.                                       ********************************************** */
+bool NIDAQmxSpectrum::popBandEnergies(vector<double> &o_bandEnergies) {
+    if (!ready) {
+        return false;
+    }
+
+    o_bandEnergies = bandEnergies;
+    ready = false;
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Accumulate the power of a segment.                               ********************************************** */
+void NIDAQmxSpectrum::accumulateSegment(const size_t &i_channel) {
+    const double *segment = &history[i_channel * fftSize];
+
+    // Remove the segment mean so that a static load does not leak into the low bands
+    double mean = 0.0;
+    for (size_t i = 0; i < fftSize; ++i) {
+        mean += segment[i];
+    }
+    mean /= fftSize;
+
+    // Window into bit-reversed order
+    for (size_t i = 0; i < fftSize; ++i) {
+        workRe[bitReversed[i]] = (segment[i] - mean) * window[i];
+        workIm[bitReversed[i]] = 0.0;
+    }
+
+    transform();
+
+    double *power = &powerSum[i_channel * (fftSize / 2 + 1)];
+    for (size_t k = 0; k <= fftSize / 2; ++k) {
+        power[k] += workRe[k] * workRe[k] + workIm[k] * workIm[k];
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* In-place radix-2 FFT.                                            ********************************************** */
+void NIDAQmxSpectrum::transform(void) {
+    double *re = &workRe[0];
+    double *im = &workIm[0];
+
+    for (size_t half = 1; half < fftSize; half <<= 1) {
+        size_t twiddleStep = fftSize / (2 * half);
+        for (size_t start = 0; start < fftSize; start += 2 * half) {
+            for (size_t k = 0; k < half; ++k) {
+                double wRe = twiddleRe[k * twiddleStep];
+                double wIm = twiddleIm[k * twiddleStep];
+                size_t top = start + k;
+                size_t bottom = top + half;
+
+                double tRe = wRe * re[bottom] - wIm * im[bottom];
+                double tIm = wRe * im[bottom] + wIm * re[bottom];
+                re[bottom] = re[top] - tRe;
+                im[bottom] = im[top] - tIm;
+                re[top] += tRe;
+                im[top] += tIm;
+            }
+        }
+    }
+}
+/* *********************************************************************************************************************** */
@@ -18,17 +18,44 @@
 
 
 #include "NIDAQmxTask.h"
+#include "NIDAQmxFunctions.h"
+#include "NIDAQmxLog.h"
 
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
 
 using namespace nidaqmx;
 
-using std::cerr;
-using std::cout;
 using std::string;
 
 
+namespace {
+    /**
+     * Thread body used by NIDAQmxTask::initialiseDAQTasks().
+     */
+    void initialiseDAQTaskThread(nidaqmx::NIDAQmxTask *i_task, char *o_result) {
+        *o_result = i_task->initialiseDAQTask();
+    }
+
+    /**
+     * Driver error codes used to classify failures, identical in NIDAQmx and NIDAQmxBase.
+     */
+    const int errorSamplesNotYetAvailable = -200284;
+    const int errorOperationTimedOut = -200474;
+    const int errorSamplesNoLongerAvailable = -200279;
+    const int errorOnboardMemoryOverflow = -200361;
+    const int errorDeviceCannotBeAccessed = -201003;
+    const int errorTransferAborted = -50405;
+
+    /**
+     * The object whose address stands for the task handle of a simulated task.
+     */
+    uInt32 simulatedTask = 0;
+}
+
+
 /* *********************************************************************************************************************** */
 /* ******* Default constructor.                                             ********************************************** */
 NIDAQmxTask::NIDAQmxTask(const nidaqmx::NIDAQmxTaskParams &aDAQTaskParams) 
@@ -36,8 +63,28 @@ NIDAQmxTask::NIDAQmxTask(const nidaqmx::NIDAQmxTaskParams &aDAQTaskParams)
       , DAQTaskConfig(aDAQTaskParams.DAQTaskName, aDAQTaskParams.DAQChannels, aDAQTaskParams.DAQChannelTypes,
             aDAQTaskParams.DAQTerminalConfig, aDAQTaskParams.DAQMinVals, aDAQTaskParams.DAQMaxVals)
       , DAQSamplingConfig(aDAQTaskParams.DAQSamplesPerChannel, aDAQTaskParams.DAQSamplingRate, aDAQTaskParams.DAQSamplingTimeout, aDAQTaskParams.DAQSamplingBufferSize)
-      , DAQCalibrationConfig(aDAQTaskParams.DAQSensorCalibScales, aDAQTaskParams.DAQSensorCalibMatrix) {
+      , DAQTriggerConfig(aDAQTaskParams.DAQTriggerType, aDAQTaskParams.DAQTriggerSource, aDAQTaskParams.DAQTriggerSlope,
+            aDAQTaskParams.DAQTriggerLevel, aDAQTaskParams.DAQPreTriggerSamples, aDAQTaskParams.DAQPostTriggerSamples)
+      , DAQCalibrationConfigs(2, NIDAQmxCalibrationConfig(aDAQTaskParams.DAQSensorCalibScales, aDAQTaskParams.DAQSensorCalibMatrix,
+            aDAQTaskParams.DAQSensorBias, aDAQTaskParams.DAQOutputTransform))
+      , DAQCalibrationIndex(0)
+      , DAQCalibrationPending(false)
+      , DAQCalibrationDeferred(false)
+      , DAQCounterConfig(aDAQTaskParams.DAQCounterChannels, aDAQTaskParams.DAQCounterChannelTypes, aDAQTaskParams.DAQCounterScales)
+      , DAQSimulated(aDAQTaskParams.DAQSimulated)
+      , DAQSimulator(aDAQTaskParams.DAQMinVals, aDAQTaskParams.DAQMaxVals)
+      , readLogLimiter(1.0)
+      , saturationLogLimiter(1.0) {
     DAQTaskHandle = 0;
+    DAQLastError = 0;
+    DAQScanIndex = 0;
+    DAQPendingDiscontinuity = 0;
+    DAQLastReadTime = 0;
+    DAQInitTimes.createTask = 0;
+    DAQInitTimes.createChannels = 0;
+    DAQInitTimes.configureTiming = 0;
+    DAQInitTimes.startTask = 0;
+    DAQInitTimes.waitReady = 0;
 
     generateMaps();
 }
@@ -55,7 +102,11 @@ NIDAQmxTask::NIDAQmxTask(const nidaqmx::NIDAQmxTaskParams &aDAQTaskParams)
 bool NIDAQmxTask::initialiseDAQTask(void) {
     // Creates and starts the DAQ Task
     if(createDAQTask()) {
-        return startDAQTask();
+        double phaseStart = monotonicNow();
+        bool result = startDAQTask();
+        DAQInitTimes.startTask = monotonicNow() - phaseStart;
+
+        return result;
     } else {
         return false;
     }
@@ -63,11 +114,147 @@ bool NIDAQmxTask::initialiseDAQTask(void) {
 /* *********************************************************************************************************************** */
 
 
+/* *********************************************************************************************************************** */
+/* ******* Initialise several DAQ Tasks concurrently.                       ********************************************** */
+bool NIDAQmxTask::initialiseDAQTasks(std::vector<NIDAQmxTask *> &i_tasks) {
+    using std::thread;
+    using std::vector;
+
+    // Devices are independent, so their driver calls can overlap
+    vector<char> results(i_tasks.size(), 0);
+    vector<thread> initThreads;
+    for (size_t i = 0; i < i_tasks.size(); ++i) {
+        initThreads.push_back(thread(initialiseDAQTaskThread, i_tasks[i], &results[i]));
+    }
+
+    bool result = true;
+    for (size_t i = 0; i < initThreads.size(); ++i) {
+        initThreads[i].join();
+        result = result && results[i];
+    }
+
+    return result;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Wait for the DAQ Task to be ready.                               ********************************************** */
+bool NIDAQmxTask::waitDAQTaskReady(const double &i_timeout) {
+    double phaseStart = monotonicNow();
+
+    // A triggered task holds no readable samples until its window is complete
+    if (DAQTriggerConfig.isTriggered()) {
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: DAQ Task armed, waiting for the trigger.");
+        DAQInitTimes.waitReady = 0;
+        return true;
+    }
+
+    // Poll the driver until the first samples are in the buffer
+    uInt32 availableSamples = 0;
+    while (availableSamples == 0) {
+        if (DAQSimulated) {
+            availableSamples = (uInt32) DAQSimulator.getAvailableScans();
+        } else {
+#ifdef __linux__
+            if (!errorCheck(DAQmxBaseGetReadAttribute(DAQTaskHandle, DAQmx_Read_AvailSampPerChan, &availableSamples))) {
+                return false;
+            }
+#elif _WIN32
+            if (!errorCheck(DAQmxGetReadAvailSampPerChan(DAQTaskHandle, &availableSamples))) {
+                return false;
+            }
+#endif
+        }
+
+        if ((availableSamples == 0) && (monotonicNow() - phaseStart > i_timeout)) {
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: No samples were acquired within %g s of starting the DAQ task.", i_timeout);
+            return false;
+        } else if (availableSamples == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    DAQInitTimes.waitReady = monotonicNow() - phaseStart;
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the initialisation times.                                    ********************************************** */
+const nidaqmx::NIDAQmxInitTimes &NIDAQmxTask::getInitTimes(void) const {
+    return DAQInitTimes;
+}
+/* *********************************************************************************************************************** */
+
+
 /* *********************************************************************************************************************** */
 /* ******* Run the DAQ Task.                                                ********************************************** */
 bool NIDAQmxTask::runDAQTask(nidaqmx::NIDAQmxResults &i_results) {
+    DAQLastError = 0;
+
+    // A triggered window can only be read once the device has captured it
+    if (DAQTriggerConfig.isTriggered()) {
+        bool32 isTaskDone = 0;
+#ifdef __linux__
+        if (!errorCheck(DAQmxBaseIsTaskDone(DAQTaskHandle, &isTaskDone))) {
+            return false;
+        }
+#elif _WIN32
+        if (!errorCheck(DAQmxIsTaskDone(DAQTaskHandle, &isTaskDone))) {
+            return false;
+        }
+#endif
+        if (!isTaskDone) {
+            i_results.analogValues.clear();
+            i_results.realValues.clear();
+            i_results.counterValues.clear();
+            i_results.saturationCounts.assign(DAQTaskConfig.getDAQChannels().size(), 0);
+            i_results.saturationFlags.clear();
+            i_results.saturatedScans = 0;
+            i_results.firstScan = DAQScanIndex;
+            i_results.discontinuity = 0;
+            return true;
+        }
+    }
+
     // Read sensor values
     if(readAnalogValues(i_results.analogValues)) {
+        DAQLastReadTime = monotonicNow();
+
+        // Number the scans, the discontinuities are reported with the first block actually holding scans
+        int nScans = i_results.analogValues.size() / DAQTaskConfig.getDAQChannels().size();
+        i_results.firstScan = DAQScanIndex;
+        i_results.discontinuity = 0;
+        if (nScans > 0) {
+            i_results.discontinuity = DAQPendingDiscontinuity;
+            DAQPendingDiscontinuity = 0;
+            DAQScanIndex += nScans;
+        }
+
+        if (DAQTriggerConfig.isTriggered()) {
+            if (!rearmDAQTask()) {
+                return false;
+            }
+
+            // The next window does not follow this one
+            DAQPendingDiscontinuity |= DiscontinuityRestart;
+        }
+
+        detectSaturation(i_results.analogValues, i_results);
+
+        // Read the counter samples latched with the same scans
+        if (!readCounterValues(nScans, i_results.counterValues)) {
+            return false;
+        }
+
+        if (DAQCalibrationDeferred) {
+            i_results.realValues.clear();
+            return true;
+        }
+
+        applyPendingCalibration();
         return computeSensorValues(i_results.analogValues, i_results.realValues);
     } else {
         return false;
@@ -76,12 +263,55 @@ bool NIDAQmxTask::runDAQTask(nidaqmx::NIDAQmxResults &i_results) {
 /* *********************************************************************************************************************** */
 
 
+/* *********************************************************************************************************************** */
+/* ******* Defer the calibration.                                           ********************************************** */
+void NIDAQmxTask::setCalibrationDeferred(const bool &i_deferred) {
+    DAQCalibrationDeferred = i_deferred;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Calibrate a block read with a deferred calibration.              ********************************************** */
+bool NIDAQmxTask::calibrateResults(nidaqmx::NIDAQmxResults &io_results) {
+    if (io_results.analogValues.empty()) {
+        io_results.realValues.clear();
+        return true;
+    }
+
+    return computeSensorValues(io_results.analogValues, io_results.realValues);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Swap in a new calibration.                                       ********************************************** */
+bool NIDAQmxTask::applyPendingCalibration(void) {
+    if (!DAQCalibrationPending.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    DAQCalibrationIndex.store(1 - DAQCalibrationIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    DAQCalibrationPending.store(false, std::memory_order_release);
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
 /* *********************************************************************************************************************** */
 /* ******* Stop the DAQ Task.                                               ********************************************** */
 bool NIDAQmxTask::stopDAQTask(void) {
     if(DAQTaskHandle != 0)  {
         // Ensure the task is stopped correctly
-        cout << "NIDAQmxTask: Stopping the DAQ Task. \n";
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Stopping the DAQ Task.");
+
+        if (DAQSimulated) {
+            DAQSimulator.stop();
+            NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Simulated DAQ Task stopped.");
+
+            return true;
+        }
 
 #ifdef __linux__
         if(!errorCheck(DAQmxBaseStopTask(DAQTaskHandle))) {
@@ -94,8 +324,21 @@ bool NIDAQmxTask::stopDAQTask(void) {
         }
 //        DAQmxClearTask(DAQTaskHandle);
 #endif
+
+        // Stop the counters once their sample clock has stopped
+        for (size_t i = 0; i < DAQCounterTaskHandles.size(); ++i) {
+#ifdef __linux__
+            if (!errorCheck(DAQmxBaseStopTask(DAQCounterTaskHandles[i]))) {
+                return false;
+            }
+#elif _WIN32
+            if (!errorCheck(DAQmxStopTask(DAQCounterTaskHandles[i]))) {
+                return false;
+            }
+#endif
+        }
         
-        cout << "NIDAQmxTask: DAQ Task stopped. \n";
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: DAQ Task stopped.");
 
         return true;
     }
@@ -110,7 +353,14 @@ bool NIDAQmxTask::stopDAQTask(void) {
 bool NIDAQmxTask::clearDAQTask(void) {
     if(DAQTaskHandle != 0)  {
         // Ensure the task is stopped correctly
-        cout << "NIDAQmxTask: Clearing the DAQ Task. \n";
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Clearing the DAQ Task.");
+
+        if (DAQSimulated) {
+            DAQTaskHandle = 0;
+            NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Simulated DAQ Task cleared.");
+
+            return true;
+        }
 
 #ifdef __linux__
 //        DAQmxBaseStopTask(DAQTaskHandle);
@@ -123,12 +373,205 @@ bool NIDAQmxTask::clearDAQTask(void) {
             return false;
         }
 #endif
+
+        for (size_t i = 0; i < DAQCounterTaskHandles.size(); ++i) {
+#ifdef __linux__
+            if (!errorCheck(DAQmxBaseClearTask(DAQCounterTaskHandles[i]))) {
+                return false;
+            }
+#elif _WIN32
+            if (!errorCheck(DAQmxClearTask(DAQCounterTaskHandles[i]))) {
+                return false;
+            }
+#endif
+        }
+        DAQCounterTaskHandles.clear();
+        DAQTaskHandle = 0;
         
-        cout << "NIDAQmxTask: DAQ Task cleared. \n";
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: DAQ Task cleared.");
+
+        return true;
+    }
+
+    return false;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the scan index.                                              ********************************************** */
+uInt64 NIDAQmxTask::getScanIndex(void) const {
+    return DAQScanIndex;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the last driver error.                                       ********************************************** */
+int NIDAQmxTask::getLastError(void) const {
+    return DAQLastError;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Classify the last driver error.                                  ********************************************** */
+nidaqmx::NIDAQmxErrorClass NIDAQmxTask::classifyLastError(void) const {
+    return classifyError(DAQLastError);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Classify a driver error code.                                    ********************************************** */
+nidaqmx::NIDAQmxErrorClass NIDAQmxTask::classifyError(const int &i_errorCode) {
+    switch (i_errorCode) {
+        case 0:
+            return ErrorNone;
+        case errorSamplesNotYetAvailable:
+        case errorOperationTimedOut:
+            return ErrorTransient;
+        case errorSamplesNoLongerAvailable:
+        case errorOnboardMemoryOverflow:
+            return ErrorOverrun;
+        case errorDeviceCannotBeAccessed:
+        case errorTransferAborted:
+            return ErrorDeviceLost;
+        default:
+            return ErrorOther;
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Recover the DAQ Task.                                            ********************************************** */
+bool NIDAQmxTask::recoverDAQTask(const double &i_budget) {
+    double recoveryStart = monotonicNow();
+    double retryDelay = 0.05;
+
+    // The samples overwritten in the buffer are reported with the next block
+    if (classifyLastError() == ErrorOverrun) {
+        DAQPendingDiscontinuity |= DiscontinuityOverrun;
+    }
+
+    for (int attempt = 1; ; ++attempt) {
+        NIDAQmxLog::log(NIDAQmxLog::Warning, "NIDAQmxTask: Recovering the DAQ Task, attempt %d.", attempt);
+        releaseDAQTask();
+
+        // Wait for the first samples with what is left of the budget
+        double remaining = i_budget - (monotonicNow() - recoveryStart);
+        if (initialiseDAQTask()) {
+            double restartTime = monotonicNow();
+            if (waitDAQTaskReady(std::max(remaining, 0.0))) {
+                // Skip the scans acquired while the task was down, so that the index keeps following the sample clock
+                if (!DAQTriggerConfig.isTriggered() && (DAQLastReadTime > 0)) {
+                    DAQScanIndex += (uInt64) ((restartTime - DAQLastReadTime) * DAQSamplingConfig.getDAQSamplingRate());
+                }
+                DAQPendingDiscontinuity |= DiscontinuityRecovery;
+                DAQLastError = 0;
+                NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: DAQ Task recovered in %g s.", monotonicNow() - recoveryStart);
+
+                return true;
+            }
+        }
+
+        // A device being re-enumerated takes a while to come back, back off between attempts
+        remaining = i_budget - (monotonicNow() - recoveryStart);
+        if (remaining <= retryDelay) {
+            releaseDAQTask();
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: Could not recover the DAQ Task within %g s.", i_budget);
+
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(retryDelay));
+        retryDelay = std::min(2 * retryDelay, 1.0);
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Release a failed DAQ Task.                                       ********************************************** */
+void NIDAQmxTask::releaseDAQTask(void) {
+    if (DAQTaskHandle != 0) {
+        stopDAQTask();
+        clearDAQTask();
+    }
+
+    // A lost device may refuse to clear, the handles are dropped anyway
+    DAQTaskHandle = 0;
+    DAQCounterTaskHandles.clear();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Set a new calibration configuration.                             ********************************************** */
+bool NIDAQmxTask::setCalibrationConfig(const std::vector<double> &aDAQSensorCalibScales, const DoubleMatrix2D &aDAQSensorCalibMatrix,
+        const std::vector<double> &aDAQSensorBias, const DoubleMatrix2D &aDAQOutputTransform) {
+    size_t DAQNChannels = DAQTaskConfig.getDAQChannels().size();
+    size_t DAQNOutputs = DAQCalibrationConfigs[0].getDAQNOutputs();
+
+    // Check the calibration size against the number of channels and of outputs, which cannot change while running
+    bool validSize = (aDAQSensorCalibScales.size() == DAQNOutputs) && (aDAQSensorCalibMatrix.size() == DAQNOutputs)
+        && (aDAQSensorBias.empty() || (aDAQSensorBias.size() == DAQNOutputs))
+        && (aDAQOutputTransform.empty() || (aDAQOutputTransform.size() == DAQNOutputs));
+    for (size_t i = 0; validSize && (i < aDAQSensorCalibMatrix.size()); ++i) {
+        validSize = (aDAQSensorCalibMatrix[i].size() == DAQNChannels);
+    }
+    for (size_t i = 0; validSize && (i < aDAQOutputTransform.size()); ++i) {
+        validSize = (aDAQOutputTransform[i].size() == DAQNOutputs);
+    }
+    if (!validSize) {
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: The new calibration does not match the number of DAQ channels (%d) and outputs (%d).",
+                (int) DAQNChannels, (int) DAQNOutputs);
+        return false;
+    }
+
+    // The spare buffer is still waiting to be swapped in by the reading thread
+    if (DAQCalibrationPending.load(std::memory_order_acquire)) {
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: A calibration change is already pending.");
+        return false;
+    }
 
+    // Fill the spare buffer and hand it over to the reading thread
+    int spareIndex = 1 - DAQCalibrationIndex.load(std::memory_order_relaxed);
+    DAQCalibrationConfigs[spareIndex] = NIDAQmxCalibrationConfig(aDAQSensorCalibScales, aDAQSensorCalibMatrix, aDAQSensorBias, aDAQOutputTransform);
+    DAQCalibrationPending.store(true, std::memory_order_release);
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Set a new sampling configuration.                                ********************************************** */
+bool NIDAQmxTask::setSamplingConfig(const nidaqmx::NIDAQmxSamplingConfig &aDAQSamplingConfig) {
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Reconfiguring the DAQ Task sampling.");
+
+    // The timing can only be changed on a stopped task
+    if (!stopDAQTask()) {
+        return false;
+    }
+
+    // The samples left in the buffer are discarded by the restart
+    NIDAQmxSamplingConfig previousSamplingConfig = DAQSamplingConfig;
+    DAQSamplingConfig = aDAQSamplingConfig;
+    DAQPendingDiscontinuity |= DiscontinuityRestart;
+    if (configureDAQTiming() && startDAQTask()) {
         return true;
     }
 
+    // Go back to the previous timing, which the recoveries would otherwise recreate the task with
+    int rejectedError = DAQLastError;
+    NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: The new sampling configuration was rejected, restoring the previous one.");
+    DAQSamplingConfig = previousSamplingConfig;
+    if (!(configureDAQTiming() && startDAQTask())) {
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: Could not restart the DAQ Task with the previous sampling configuration.");
+    }
+    DAQLastError = rejectedError;
+
     return false;
 }
 /* *********************************************************************************************************************** */
@@ -138,7 +581,24 @@ bool NIDAQmxTask::clearDAQTask(void) {
 /* ******* Create the DAQ Task.                                             ********************************************** */
 bool NIDAQmxTask::createDAQTask(void) {
     // Create the DAQ task
-    cout << "NIDAQmxTask: Creating the DAQ task. \n";
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Creating the DAQ task.");
+    double phaseStart = monotonicNow();
+
+    // The simulated device has no driver task nor channels, it only needs the channel ranges given to the constructor
+    if (DAQSimulated) {
+        if (DAQTriggerConfig.isTriggered()) {
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: Triggered acquisition cannot be simulated.");
+            return false;
+        }
+
+        DAQTaskHandle = (TaskHandle) &simulatedTask;
+        DAQInitTimes.createTask = monotonicNow() - phaseStart;
+        DAQInitTimes.createChannels = 0;
+        DAQInitTimes.configureTiming = 0;
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Simulated DAQ Task created with %d channels.", (int) DAQTaskConfig.getDAQChannels().size());
+
+        return true;
+    }
 
 #ifdef __linux__
     if (!errorCheck(DAQmxBaseCreateTask(DAQTaskConfig.getDAQTaskName().c_str(), &DAQTaskHandle))) {
@@ -150,35 +610,77 @@ bool NIDAQmxTask::createDAQTask(void) {
     }
 #endif
 
-    cout << "NIDAQmxTask: DAQ Task created. \n";
+    DAQInitTimes.createTask = monotonicNow() - phaseStart;
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: DAQ Task created.");
 
 
     // Create the DAQ channels
-    cout << "NIDAQmxTask: Creating the DAQ channels associated with the task. \n";
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Creating the DAQ channels associated with the task.");
+    phaseStart = monotonicNow();
     if (!createDAQChannels()) {
         return false;
     }
-    cout << "NIDAQmxTask: All DAQ channels created. \n";
+    if (!createDAQCounterTasks()) {
+        return false;
+    }
+    DAQInitTimes.createChannels = monotonicNow() - phaseStart;
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: All DAQ channels created.");
+
+    // Define the sampling rate, timing and buffer
+    phaseStart = monotonicNow();
+    bool result = configureDAQTiming();
+    DAQInitTimes.configureTiming = monotonicNow() - phaseStart;
+
+    return result;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Configure the DAQ Task timing.                                   ********************************************** */
+bool NIDAQmxTask::configureDAQTiming(void) {
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Defining sampling rate and timing.");
+
+    // The simulated device takes the sampling configuration when started
+    if (DAQSimulated) {
+        return true;
+    }
 
-    // Define the sampling rate and timing
-    cout << "NIDAQmxTask: Defining sampling rate and timing. \n";
-    int nTotSamples = DAQSamplingConfig.getDAQSamplesPerChannel() * DAQTaskConfig.getDAQChannels().size();        // Total number of samples
+    // A triggered task acquires a single finite window around the trigger
+    if (DAQTriggerConfig.isTriggered()) {
+        uInt64 windowSamples = DAQTriggerConfig.getDAQPreTriggerSamples() + DAQTriggerConfig.getDAQPostTriggerSamples();
+
+#ifdef __linux__
+        if (!errorCheck(DAQmxBaseCfgSampClkTiming(DAQTaskHandle, "OnboardClock", DAQSamplingConfig.getDAQSamplingRate(),
+                DAQmx_Val_Rising, DAQmx_Val_FiniteSamps, windowSamples))) {
+            return false;
+        }
+#elif _WIN32
+        if (!errorCheck(DAQmxCfgSampClkTiming(DAQTaskHandle, "OnBoardClock", DAQSamplingConfig.getDAQSamplingRate(),
+                DAQmx_Val_Rising, DAQmx_Val_FiniteSamps, windowSamples))) {
+            return false;
+        }
+#endif
+
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Sampling rate and timing defined.");
+
+        // The driver sizes the buffer to the window
+        return configureDAQTrigger();
+    }
 
 #ifdef __linux__
     if (!errorCheck(DAQmxBaseCfgSampClkTiming(DAQTaskHandle, "OnboardClock", DAQSamplingConfig.getDAQSamplingRate(), 
-//            DAQmx_Val_Rising, DAQmx_Val_FiniteSamps, DAQSamplingConfig.getDAQSamplesPerChannel()))) {
             DAQmx_Val_Rising, DAQmx_Val_ContSamps, DAQSamplingConfig.getDAQSamplesPerChannel()))) {
         return false;
     }
 #elif _WIN32
     if (!errorCheck(DAQmxCfgSampClkTiming(DAQTaskHandle, "OnBoardClock", DAQSamplingConfig.getDAQSamplingRate(), 
-//            DAQmx_Val_Rising, DAQmx_Val_FiniteSamps, DAQSamplingConfig.getDAQSamplesPerChannel()))) {
             DAQmx_Val_Rising, DAQmx_Val_ContSamps, DAQSamplingConfig.getDAQSamplesPerChannel()))) {
         return false;
     }
 #endif
 
-    cout << "NIDAQmxTask: Sampling rate and timing defined. \n";
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Sampling rate and timing defined.");
 
 
 //    if (!errorCheck(DAQmxBaseCfgInputBuffer(DAQTaskHandle, nTotSamples*2))) {
@@ -192,70 +694,205 @@ bool NIDAQmxTask::createDAQTask(void) {
     }
 #endif
 
+    // The counters sample on the analog input sample clock, with the same rate and buffer
+    string sampleClock = "/" + DAQDeviceName + "/ai/SampleClock";
+    for (size_t i = 0; i < DAQCounterTaskHandles.size(); ++i) {
+#ifdef __linux__
+        if (!errorCheck(DAQmxBaseCfgSampClkTiming(DAQCounterTaskHandles[i], sampleClock.c_str(), DAQSamplingConfig.getDAQSamplingRate(),
+                DAQmx_Val_Rising, DAQmx_Val_ContSamps, DAQSamplingConfig.getDAQSamplesPerChannel()))) {
+            return false;
+        }
+        if (!errorCheck(DAQmxBaseCfgInputBuffer(DAQCounterTaskHandles[i], DAQSamplingConfig.getDAQSamplingBufferSize()))) {
+            return false;
+        }
+#elif _WIN32
+        if (!errorCheck(DAQmxCfgSampClkTiming(DAQCounterTaskHandles[i], sampleClock.c_str(), DAQSamplingConfig.getDAQSamplingRate(),
+                DAQmx_Val_Rising, DAQmx_Val_ContSamps, DAQSamplingConfig.getDAQSamplesPerChannel()))) {
+            return false;
+        }
+        if (!errorCheck(DAQmxCfgInputBuffer(DAQCounterTaskHandles[i], DAQSamplingConfig.getDAQSamplingBufferSize()))) {
+            return false;
+        }
+#endif
+    }
+
     return true;
 }
 /* *********************************************************************************************************************** */
 
 
+/* *********************************************************************************************************************** */
+/* ******* Configure the DAQ Task reference trigger.                        ********************************************** */
+bool NIDAQmxTask::configureDAQTrigger(void) {
+    using std::map;
+
+    map<string, int>::iterator slope = triggerSlopes.find(DAQTriggerConfig.getDAQTriggerSlope());
+    if (slope == triggerSlopes.end()) {
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: The DAQ trigger slope provided - (%s) is invalid. Check the configuration file.", DAQTriggerConfig.getDAQTriggerSlope().c_str());
+        return false;
+    }
+
+    string triggerSource = "/" + DAQDeviceName + "/" + DAQTriggerConfig.getDAQTriggerSource();
+    uInt32 preTriggerSamples = DAQTriggerConfig.getDAQPreTriggerSamples();
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Configuring %s trigger on %s with %u pre-trigger samples.", DAQTriggerConfig.getDAQTriggerType().c_str(),
+            triggerSource.c_str(), (unsigned int) preTriggerSamples);
+
+    if (DAQTriggerConfig.getDAQTriggerType() == "AnalogEdge") {
+#ifdef __linux__
+        return errorCheck(DAQmxBaseCfgAnlgEdgeRefTrig(DAQTaskHandle, triggerSource.c_str(), slope->second, DAQTriggerConfig.getDAQTriggerLevel(), preTriggerSamples));
+#elif _WIN32
+        return errorCheck(DAQmxCfgAnlgEdgeRefTrig(DAQTaskHandle, triggerSource.c_str(), slope->second, DAQTriggerConfig.getDAQTriggerLevel(), preTriggerSamples));
+#endif
+    } else if (DAQTriggerConfig.getDAQTriggerType() == "DigitalEdge") {
+#ifdef __linux__
+        return errorCheck(DAQmxBaseCfgDigEdgeRefTrig(DAQTaskHandle, triggerSource.c_str(), slope->second, preTriggerSamples));
+#elif _WIN32
+        return errorCheck(DAQmxCfgDigEdgeRefTrig(DAQTaskHandle, triggerSource.c_str(), slope->second, preTriggerSamples));
+#endif
+    } else {
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: The DAQ trigger type provided - (%s) is invalid. Check the configuration file.", DAQTriggerConfig.getDAQTriggerType().c_str());
+        return false;
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Re-arm a triggered DAQ Task.                                     ********************************************** */
+bool NIDAQmxTask::rearmDAQTask(void) {
+    NIDAQmxLog::log(NIDAQmxLog::Debug, "NIDAQmxTask: Trigger window read, re-arming the trigger.");
+
+#ifdef __linux__
+    return errorCheck(DAQmxBaseStopTask(DAQTaskHandle)) && errorCheck(DAQmxBaseStartTask(DAQTaskHandle));
+#elif _WIN32
+    return errorCheck(DAQmxStopTask(DAQTaskHandle)) && errorCheck(DAQmxStartTask(DAQTaskHandle));
+#endif
+}
+/* *********************************************************************************************************************** */
+
+
 /* *********************************************************************************************************************** */
 /* ******* Create the DAQ Channels.                                         ********************************************** */
 bool NIDAQmxTask::createDAQChannels(void) {
-    using std::stringstream;
     using std::map;
+    using std::vector;
 
-    bool result = true;
-
-    // Create the acquisition channels according to the task configuration object
-    stringstream channelName;
-    int channelType;
-    int terminalConfig;
+    size_t DAQNChannels = DAQTaskConfig.getDAQChannels().size();
+    vector<string> &channelType = DAQTaskConfig.getDAQChannelTypes();
+    vector<int> terminalConfig(DAQNChannels);
 
-    // TODO: Change this to construct channel depending on channel type
-    for (size_t i = 0; i < DAQTaskConfig.getDAQChannels().size(); ++i) {
-        channelName.str(std::string());     // Clear stringstream
-        channelName << DAQDeviceName << "/" << DAQTaskConfig.getDAQChannels()[i];      // Construct the channel name
-        cout << "NIDAQmxTask: Creating DAQ channel - " << channelName.str()  << ". \n";
-        
-        // Find channel type
-        map<string, int>::iterator curVal = channelTypes.find(DAQTaskConfig.getDAQChannelTypes()[i]);
-        if (curVal != channelTypes.end()) {       // Current channel type exists
-            channelType = curVal->second;
-        } else {        // Current channel type does not exist
-            cerr << "NIDAQmxTask: Error: The DAQ channel type provided - (" << DAQTaskConfig.getDAQChannelTypes()[i] << ") is invalid. Check the configuration file. \n";
-            cerr << "NIDAQmxTask: Error: Could not initalise the DAQ task. \n";
+    // Check the channel types and resolve the terminal configurations before touching the driver
+    for (size_t i = 0; i < DAQNChannels; ++i) {
+        // Check channel type
+        if (!channelFactory.hasChannelType(channelType[i]) || (channelFactory.getChannelKind(channelType[i]) != AnalogInput)) {
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: The DAQ channel type provided - (%s) is invalid. Check the configuration file.", channelType[i].c_str());
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: Could not initalise the DAQ task.");
 
-            result = false;
-            break;
+            return false;
         }
         // Find terminal config
-        curVal = terminalConfigs.find(DAQTaskConfig.getDAQTerminalConfig()[i]);
+        map<string, int>::iterator curVal = terminalConfigs.find(DAQTaskConfig.getDAQTerminalConfig()[i]);
         if (curVal != terminalConfigs.end()) {       // Current channel type exists
-            terminalConfig = curVal->second;    // Convert to int
+            terminalConfig[i] = curVal->second;    // Convert to int
         } else {        // Current channel type does not exist
-            cerr << "NIDAQmxTask: Error: The DAQ terminal configuration provided - (" << DAQTaskConfig.getDAQTerminalConfig()[i] << ") is invalid. Check the configuration file. \n";
-            cerr << "NIDAQmxTask: Error: Could not initalise the DAQ task. \n";
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: The DAQ terminal configuration provided - (%s) is invalid. Check the configuration file.", DAQTaskConfig.getDAQTerminalConfig()[i].c_str());
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: Could not initalise the DAQ task.");
 
-            result = false;
-            break;
+            return false;
         }
-        
+    }
+
+    // Consecutive channels sharing the same type and settings are created with a single driver call
+    size_t first = 0;
+    while (first < DAQNChannels) {
+        size_t last = first + 1;
+        while ((last < DAQNChannels) && (channelType[last] == channelType[first]) && (terminalConfig[last] == terminalConfig[first])
+                && (DAQTaskConfig.getDAQMinVals()[last] == DAQTaskConfig.getDAQMinVals()[first])
+                && (DAQTaskConfig.getDAQMaxVals()[last] == DAQTaskConfig.getDAQMaxVals()[first])) {
+            ++last;
+        }
+
+        // Construct the comma-separated physical channel list
+        string channelNames;
+        for (size_t i = first; i < last; ++i) {
+            if (i > first) {
+                channelNames += ",";
+            }
+            channelNames += DAQDeviceName + "/" + DAQTaskConfig.getDAQChannels()[i];
+        }
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Creating %s channels - %s.", channelType[first].c_str(), channelNames.c_str());
+
+        NIDAQmxChannelSpec spec;
+        spec.physicalChannels = channelNames;
+        spec.terminalConfig = terminalConfig[first];
+        spec.minVal = DAQTaskConfig.getDAQMinVals()[first];
+        spec.maxVal = DAQTaskConfig.getDAQMaxVals()[first];
+        if (!errorCheck(channelFactory.createChannels(DAQTaskHandle, channelType[first], spec))) {
+            return false;
+        }
+
+        first = last;
+    }
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Create the DAQ Counter Tasks.                                    ********************************************** */
+bool NIDAQmxTask::createDAQCounterTasks(void) {
+    using std::vector;
+
+    vector<string> &counterChannels = DAQCounterConfig.getDAQCounterChannels();
+    vector<string> &counterTypes = DAQCounterConfig.getDAQCounterChannelTypes();
+    vector<double> &counterScales = DAQCounterConfig.getDAQCounterScales();
+
+    if (DAQTriggerConfig.isTriggered() && !counterChannels.empty()) {
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: DAQ counters cannot be acquired in triggered mode.");
+        return false;
+    }
+
+    if ((counterTypes.size() != counterChannels.size()) || (counterScales.size() != counterChannels.size())) {
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: The DAQ counter types and scales do not match the number of DAQ counters (%d).", (int) counterChannels.size());
+        return false;
+    }
+
+    for (size_t i = 0; i < counterChannels.size(); ++i) {
+        // Check channel type
+        if (!channelFactory.hasChannelType(counterTypes[i]) || (channelFactory.getChannelKind(counterTypes[i]) != CounterInput)) {
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: The DAQ counter type provided - (%s) is invalid. Check the configuration file.", counterTypes[i].c_str());
+            return false;
+        }
+
+        // Each counter needs its own task
+        string taskName = DAQTaskConfig.getDAQTaskName() + "_" + counterChannels[i];
+        TaskHandle counterTaskHandle = 0;
 #ifdef __linux__
-        if(!errorCheck(DAQmxBaseCreateAIVoltageChan(DAQTaskHandle, channelName.str().c_str(), "", terminalConfig,
-                    DAQTaskConfig.getDAQMinVals()[i], DAQTaskConfig.getDAQMaxVals()[i], channelType, NULL))) {
-            result = false;
-            break;
+        if (!errorCheck(DAQmxBaseCreateTask(taskName.c_str(), &counterTaskHandle))) {
+            return false;
         }
 #elif _WIN32
-		if(!errorCheck(DAQmxCreateAIVoltageChan(DAQTaskHandle, channelName.str().c_str(), "", terminalConfig,
-                    DAQTaskConfig.getDAQMinVals()[i], DAQTaskConfig.getDAQMaxVals()[i], channelType, NULL))) {
-            result = false;
-            break;
+        if (!errorCheck(DAQmxCreateTask(taskName.c_str(), &counterTaskHandle))) {
+            return false;
         }
 #endif
-        cout << "NIDAQmxTask: DAQ channel created. \n";
+        DAQCounterTaskHandles.push_back(counterTaskHandle);
+
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Creating %s counter - %s/%s.", counterTypes[i].c_str(), DAQDeviceName.c_str(), counterChannels[i].c_str());
+
+        NIDAQmxChannelSpec spec;
+        spec.physicalChannels = DAQDeviceName + "/" + counterChannels[i];
+        spec.terminalConfig = DAQTerminalConfig::Default;
+        spec.minVal = 0.0;
+        spec.maxVal = 0.0;
+        spec.scale = counterScales[i];
+        if (!errorCheck(channelFactory.createChannels(counterTaskHandle, counterTypes[i], spec))) {
+            return false;
+        }
     }
 
-    return result;
+    return true;
 }
 /* *********************************************************************************************************************** */
 
@@ -263,22 +900,43 @@ bool NIDAQmxTask::createDAQChannels(void) {
 /* *********************************************************************************************************************** */
 /* ******* Start the DAQ Task.                                              ********************************************** */
 bool NIDAQmxTask::startDAQTask(void) {
-    cout << "NIDAQmxTask: Starting the DAQ Task. \n";
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Starting the DAQ Task.");
+
+    if (DAQSimulated) {
+        DAQSimulator.start(DAQSamplingConfig.getDAQSamplingRate(), DAQSamplingConfig.getDAQSamplingBufferSize());
+        NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: Simulated DAQ Task started at %g Hz.", DAQSamplingConfig.getDAQSamplingRate());
+
+        return true;
+    }
+
+    // The counters must be armed before their sample clock starts
+    for (size_t i = 0; i < DAQCounterTaskHandles.size(); ++i) {
+#ifdef __linux__
+        if (!errorCheck(DAQmxBaseStartTask(DAQCounterTaskHandles[i]))) {
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Could not start the DAQ counter tasks.");
+            return false;
+        }
+#elif _WIN32
+        if (!errorCheck(DAQmxStartTask(DAQCounterTaskHandles[i]))) {
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Could not start the DAQ counter tasks.");
+            return false;
+        }
+#endif
+    }
 
-    string errMsg = "NIDAQmxTask: Could not start the DAQ task. \n";
 #ifdef __linux__
     if(!errorCheck(DAQmxBaseStartTask(DAQTaskHandle))) {
-        cerr << errMsg;
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Could not start the DAQ task.");
         return false;
     }
 #elif _WIN32
     if(!errorCheck(DAQmxStartTask(DAQTaskHandle))) {
-        cerr << errMsg;
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Could not start the DAQ task.");
         return false;
     }
 #endif
 
-    cout << "NIDAQmxTask: DAQ Task started. \n";
+    NIDAQmxLog::log(NIDAQmxLog::Info, "NIDAQmxTask: DAQ Task started.");
 
 	return true;
 }
@@ -288,26 +946,37 @@ bool NIDAQmxTask::startDAQTask(void) {
 /* *********************************************************************************************************************** */
 /* ******* Read the values and store them.                                  ********************************************** */
 bool NIDAQmxTask::readAnalogValues(std::vector<double> &i_analog) {
-    int nTotSamples = DAQSamplingConfig.getDAQSamplesPerChannel() * DAQTaskConfig.getDAQChannels().size();        // Total number of samples
+    int nScans = DAQTriggerConfig.isTriggered() ? (DAQTriggerConfig.getDAQPreTriggerSamples() + DAQTriggerConfig.getDAQPostTriggerSamples())
+        : DAQSamplingConfig.getDAQSamplesPerChannel();
+    int nTotSamples = nScans * DAQTaskConfig.getDAQChannels().size();        // Total number of samples
     int bufSize = nTotSamples * 2;
   
     // Read samples
-    cout << "NIDAQmxTask: Reading samples. \n";
-    //double data[bufSize];
-	double *data = new double[bufSize];		// FG: Dynamically allocate this to please Visual Studio
+    if (analogBuffer.size() < (size_t) bufSize) {
+        analogBuffer.resize(bufSize);
+    }
+    double *data = &analogBuffer[0];
     int32 readSamples = 0;
 
+    if (DAQSimulated) {
+        // Reported like the driver reports an overrun, so that the task is recovered the same way
+        if (!DAQSimulator.read(bufSize / DAQTaskConfig.getDAQChannels().size(), data, readSamples)) {
+            errorCheck(errorSamplesNoLongerAvailable);
+            return false;
+        }
+    } else {
 #ifdef __linux__
-    if(!errorCheck(DAQmxBaseReadAnalogF64(DAQTaskHandle, -1, DAQSamplingConfig.getDAQSamplingTimeout(), DAQmx_Val_GroupByScanNumber, 
-                data, bufSize, &readSamples, NULL))) {
-        return false;
-    }
+        if(!errorCheck(DAQmxBaseReadAnalogF64(DAQTaskHandle, -1, DAQSamplingConfig.getDAQSamplingTimeout(), DAQmx_Val_GroupByScanNumber, 
+                    data, bufSize, &readSamples, NULL))) {
+            return false;
+        }
 #elif _WIN32
-    if(!errorCheck(DAQmxReadAnalogF64(DAQTaskHandle, -1, DAQSamplingConfig.getDAQSamplingTimeout(), DAQmx_Val_GroupByScanNumber, 
-                data, bufSize/2, &readSamples, NULL))) {
-        return false;
-    }
+        if(!errorCheck(DAQmxReadAnalogF64(DAQTaskHandle, -1, DAQSamplingConfig.getDAQSamplingTimeout(), DAQmx_Val_GroupByScanNumber, 
+                    data, bufSize/2, &readSamples, NULL))) {
+            return false;
+        }
 #endif
+    }
     
     // Store data
     int totReadVals = readSamples * DAQTaskConfig.getDAQChannels().size();
@@ -317,20 +986,60 @@ bool NIDAQmxTask::readAnalogValues(std::vector<double> &i_analog) {
     for (int i = 0; i < totReadVals; ++i) {
         i_analog[i] = data[i];
 //		i_analog.push_back(data[i]);
-    
-#if 0
-        cout << i_analog[i] << " ";
-        if ((i+1) % 6 == 0) {
-            cout << "\n";
+    }
+
+    // Report the read size at most once per second
+    unsigned int suppressed;
+    if (NIDAQmxLog::isEnabled(NIDAQmxLog::Debug) && readLogLimiter.allow(suppressed)) {
+        NIDAQmxLog::log(NIDAQmxLog::Debug, "NIDAQmxTask: %d samples read per channel (%u reads not reported).", (int) readSamples, suppressed);
+    }
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Read the counter values and store them.                          ********************************************** */
+bool NIDAQmxTask::readCounterValues(const int &i_nScans, std::vector<double> &o_counter) {
+    size_t nCounters = DAQSimulated ? DAQCounterConfig.getDAQCounterChannels().size() : DAQCounterTaskHandles.size();
+
+    o_counter.resize(i_nScans * nCounters);
+    if ((nCounters == 0) || (i_nScans == 0)) {
+        return true;
+    }
+
+    if (DAQSimulated) {
+        DAQSimulator.readCounters(i_nScans, nCounters, o_counter);
+        return true;
+    }
+
+    counterBuffer.resize(i_nScans);
+    for (size_t c = 0; c < nCounters; ++c) {
+        // Read exactly as many samples as analog scans, waiting for the last clock edges if needed
+        int32 readSamples = 0;
+#ifdef __linux__
+        if (!errorCheck(DAQmxBaseReadCounterF64(DAQCounterTaskHandles[c], i_nScans, DAQSamplingConfig.getDAQSamplingTimeout(),
+                &counterBuffer[0], i_nScans, &readSamples, NULL))) {
+            return false;
+        }
+#elif _WIN32
+        if (!errorCheck(DAQmxReadCounterF64(DAQCounterTaskHandles[c], i_nScans, DAQSamplingConfig.getDAQSamplingTimeout(),
+                &counterBuffer[0], i_nScans, &readSamples, NULL))) {
+            return false;
         }
 #endif
-    }
-//    cout << "\n";
 
-    cout << "NIDAQmxTask: " << readSamples << " samples read per channel. \n";
+        if (readSamples != i_nScans) {
+            NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error: Read %d counter samples for %d analog scans.", (int) readSamples, i_nScans);
+            return false;
+        }
 
-	// Deallocate memory
-	delete data;
+        // Interleave by scan, like the analog values
+        for (int s = 0; s < i_nScans; ++s) {
+            o_counter[s * nCounters + c] = counterBuffer[s];
+        }
+    }
 
     return true;
 }
@@ -340,32 +1049,120 @@ bool NIDAQmxTask::readAnalogValues(std::vector<double> &i_analog) {
 /* *********************************************************************************************************************** */
 /* ******* Computer actual sensor values from analogue samples.             ********************************************** */
 bool NIDAQmxTask::computeSensorValues(std::vector<double> &i_analog, std::vector<double> &o_real) {
-    // Resize output vector
-    o_real.resize(i_analog.size(), 0.0);
+    NIDAQmxCalibrationConfig &DAQCalibrationConfig = DAQCalibrationConfigs[DAQCalibrationIndex.load(std::memory_order_relaxed)];
 
-    // Matrix multiply samples x calibrationMatrix
+    // Resize output vector, one value per calibration matrix row for each scan
     size_t DAQNChannels = DAQTaskConfig.getDAQChannels().size();
-
-    size_t samp = 0;
-    while (samp < i_analog.size()) {    // Loop all samples
-        // Multiply calibration matrix
-        for (size_t i = 0; i < DAQNChannels; ++i) {    // Loop rows
-            double tmpVal = 0;
-            for (size_t j = 0; j < DAQNChannels; ++j) {    // Loop columns
-                // Matrix multiply with calibration matrix
-                tmpVal +=  DAQCalibrationConfig.getDAQSensorCalibMatrix()[i][j] * i_analog[j+samp];
+    size_t DAQNOutputs = DAQCalibrationConfig.getDAQNOutputs();
+    size_t nScans = i_analog.size() / DAQNChannels;
+    o_real.resize(nScans * DAQNOutputs, 0.0);
+
+    // Apply the composed affine map y = A x + b to every scan, skipping the zero coefficients of A
+    const double *affineOffset = &DAQCalibrationConfig.getDAQAffineOffset()[0];
+    const std::vector<double> &coefficients = DAQCalibrationConfig.getDAQAffineCoefficients();
+    const double *packed = coefficients.empty() ? NULL : &coefficients[0];
+
+    if (DAQCalibrationConfig.getDAQAffineLayout() == AffineBlocks) {
+        const std::vector<NIDAQmxAffineBlock> &blocks = DAQCalibrationConfig.getDAQAffineBlocks();
+
+        for (size_t s = 0; s < nScans; ++s) {    // Loop all scans
+            const double *x = &i_analog[s * DAQNChannels];
+            double *y = &o_real[s * DAQNOutputs];
+            for (size_t b = 0; b < blocks.size(); ++b) {    // Loop blocks
+                const NIDAQmxAffineBlock &block = blocks[b];
+                const double *xBlock = x + block.firstColumn;
+                for (size_t i = 0; i < block.nRows; ++i) {    // Loop block rows
+                    const double *row = packed + block.offset + i * block.nColumns;
+                    double tmpVal = affineOffset[block.firstRow + i];
+                    for (size_t j = 0; j < block.nColumns; ++j) {    // Loop block columns
+                        tmpVal += row[j] * xBlock[j];
+                    }
+
+                    // Store value
+                    y[block.firstRow + i] = tmpVal;
+                }
+            }
+        }
+    } else {
+        const std::vector<size_t> &columns = DAQCalibrationConfig.getDAQAffineColumns();
+        const std::vector<size_t> &rowStarts = DAQCalibrationConfig.getDAQAffineRowStarts();
+
+        for (size_t s = 0; s < nScans; ++s) {    // Loop all scans
+            const double *x = &i_analog[s * DAQNChannels];
+            double *y = &o_real[s * DAQNOutputs];
+            for (size_t i = 0; i < DAQNOutputs; ++i) {    // Loop rows
+                double tmpVal = affineOffset[i];
+                for (size_t k = rowStarts[i]; k < rowStarts[i+1]; ++k) {    // Loop non-zero coefficients
+                    tmpVal += packed[k] * x[columns[k]];
+                }
+
+                // Store value
+                y[i] = tmpVal;
             }
+        }
+    }
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Detect saturated analog values.                                  ********************************************** */
+void NIDAQmxTask::detectSaturation(const std::vector<double> &i_analog, nidaqmx::NIDAQmxResults &o_results) {
+    size_t DAQNChannels = DAQTaskConfig.getDAQChannels().size();
+    size_t nValues = i_analog.size();
+    size_t nScans = nValues / DAQNChannels;
+
+    o_results.saturationCounts.assign(DAQNChannels, 0);
+    o_results.saturationFlags.assign(nScans, 0);
+    o_results.saturatedScans = 0;
+    if (nValues == 0) {
+        return;
+    }
 
-            // Divide by calibration scales
-            tmpVal = tmpVal / DAQCalibrationConfig.getDAQSensorCalibScales()[i];
+    if (saturationMin.empty()) {
+        saturationMin = DAQTaskConfig.getDAQMinVals();
+        saturationMax = DAQTaskConfig.getDAQMaxVals();
+    }
+    repeatChannelValues(saturationMin, DAQNChannels, nValues);
+    repeatChannelValues(saturationMax, DAQNChannels, nValues);
+
+    // Most blocks have no saturated value, which a single vectorised pass establishes
+    const double *values = &i_analog[0];
+    const double *minVals = &saturationMin[0];
+    const double *maxVals = &saturationMax[0];
+    double nSaturated = 0.0;
+    for (size_t i = 0; i < nValues; ++i) {
+        nSaturated += ((values[i] <= minVals[i]) | (values[i] >= maxVals[i])) ? 1.0 : 0.0;
+    }
+    if (nSaturated == 0.0) {
+        return;
+    }
 
-            // Store value
-            o_real[i+samp] = tmpVal;
+    // Only then are the saturated values attributed to their channel and scan
+    for (size_t s = 0; s < nScans; ++s) {
+        unsigned int flags = 0;
+        for (size_t j = 0; j < DAQNChannels; ++j) {
+            size_t i = s * DAQNChannels + j;
+            if ((values[i] <= minVals[i]) || (values[i] >= maxVals[i])) {
+                ++o_results.saturationCounts[j];
+                if (j < 32) {
+                    flags |= 1u << j;
+                }
+            }
+        }
+        o_results.saturationFlags[s] = flags;
+        if (flags != 0) {
+            ++o_results.saturatedScans;
         }
-        samp += DAQNChannels;
     }
 
-    return true;
+    unsigned int suppressed;
+    if (NIDAQmxLog::isEnabled(NIDAQmxLog::Warning) && saturationLogLimiter.allow(suppressed)) {
+        NIDAQmxLog::log(NIDAQmxLog::Warning, "NIDAQmxTask: Warning: %u of %u scans reached the channel limits (%u warnings not reported).",
+                o_results.saturatedScans, (unsigned int) nScans, suppressed);
+    }
 }
 /* *********************************************************************************************************************** */
 
@@ -374,15 +1171,23 @@ bool NIDAQmxTask::computeSensorValues(std::vector<double> &i_analog, std::vector
 /* ******* DAQmx Error handling done sensibly.                              ********************************************** */
 bool NIDAQmxTask::errorCheck(int i_errorCode) {
     if(DAQmxFailed(i_errorCode)) {
+        // Keep the code for classifyLastError()
+        DAQLastError = i_errorCode;
+
         // Print the error
         char errorBuff[2048] = {'\0'};
 
+        if (DAQSimulated) {
+            snprintf(errorBuff, sizeof(errorBuff), "Simulated driver error");
+        } else {
 #ifdef __linux__
-        DAQmxBaseGetExtendedErrorInfo(errorBuff, 2048);
+            DAQmxBaseGetExtendedErrorInfo(errorBuff, 2048);
 #elif _WIN32
-        DAQmxGetExtendedErrorInfo(errorBuff, 2048);
+            DAQmxGetExtendedErrorInfo(errorBuff, 2048);
 #endif
-        cerr << "NIDAQmxTask: Error: " << errorBuff << ". \n";
+        }
+        // The code goes first, the log truncates the extended information to its message length
+        NIDAQmxLog::log(NIDAQmxLog::Error, "NIDAQmxTask: Error %d: %s.", i_errorCode, errorBuff);
 
         //// Stop the task
         //stopDAQTask();
@@ -399,31 +1204,32 @@ bool NIDAQmxTask::errorCheck(int i_errorCode) {
 /* *********************************************************************************************************************** */
 /* ******* Generate the maps.                                               ********************************************** */
 void NIDAQmxTask::generateMaps(void) {
-    generateChannelTypesMap();
     generateTerminalConfigsMap();
+    generateTriggerSlopesMap();
 }
 /* *********************************************************************************************************************** */
 
 
 /* *********************************************************************************************************************** */
-/* ******* Generate the mapping for channel types.                          ********************************************** */
-void NIDAQmxTask::generateChannelTypesMap(void) {
+/* ******* Generate the mapping for terminal configurations.                ********************************************** */
+void NIDAQmxTask::generateTerminalConfigsMap(void) {
     using std::map;
     using std::pair;
 
-    channelTypes.insert(pair<string, int> ("AIVoltage", DAQChannelType::Volts));
-    channelTypes.insert(pair<string, int> ("AICurrent", DAQChannelType::Amps));
+    terminalConfigs.insert(pair<string, int> ("Default", DAQTerminalConfig::Default));
+    terminalConfigs.insert(pair<string, int> ("Diff", DAQTerminalConfig::Diff));
+    terminalConfigs.insert(pair<string, int> ("RSE", DAQTerminalConfig::RSE));
+    terminalConfigs.insert(pair<string, int> ("NRSE", DAQTerminalConfig::NRSE));
 }
 /* *********************************************************************************************************************** */
 
 
 /* *********************************************************************************************************************** */
-/* ******* Generate the mapping for terminal configurations.                ********************************************** */
-void NIDAQmxTask::generateTerminalConfigsMap(void) {
-    using std::map;
+/* ******* Generate the mapping for trigger slopes.                         ********************************************** */
+void NIDAQmxTask::generateTriggerSlopesMap(void) {
     using std::pair;
 
-    terminalConfigs.insert(pair<string, int> ("Default", DAQTerminalConfig::Default));
-    terminalConfigs.insert(pair<string, int> ("Diff", DAQTerminalConfig::Diff));
+    triggerSlopes.insert(pair<string, int> ("Rising", DAQTriggerSlope::Rising));
+    triggerSlopes.insert(pair<string, int> ("Falling", DAQTriggerSlope::Falling));
 }
 /* *********************************************************************************************************************** */
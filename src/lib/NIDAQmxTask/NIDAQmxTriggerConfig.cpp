@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+
+#include "NIDAQmxTriggerConfig.h"
+
+using nidaqmx::NIDAQmxTriggerConfig;
+using std::string;
+
+/* *********************************************************************************************************************** */
+/* ******* Default Constructor.                                             ********************************************** */
+NIDAQmxTriggerConfig::NIDAQmxTriggerConfig(const string &aDAQTriggerType, const string &aDAQTriggerSource, const string &aDAQTriggerSlope,
+        const double &aDAQTriggerLevel, const int &aDAQPreTriggerSamples, const int &aDAQPostTriggerSamples) {
+    DAQTriggerType = aDAQTriggerType;
+    DAQTriggerSource = aDAQTriggerSource;
+    DAQTriggerSlope = aDAQTriggerSlope;
+    DAQTriggerLevel = aDAQTriggerLevel;
+    DAQPreTriggerSamples = aDAQPreTriggerSamples;
+    DAQPostTriggerSamples = aDAQPostTriggerSamples;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ Trigger type.                                        ********************************************** */
+string &NIDAQmxTriggerConfig::getDAQTriggerType() {
+    return DAQTriggerType;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ Trigger source.                                      ********************************************** */
+string &NIDAQmxTriggerConfig::getDAQTriggerSource() {
+    return DAQTriggerSource;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ Trigger slope.                                       ********************************************** */
+string &NIDAQmxTriggerConfig::getDAQTriggerSlope() {
+    return DAQTriggerSlope;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ Trigger level.                                       ********************************************** */
+double &NIDAQmxTriggerConfig::getDAQTriggerLevel() {
+    return DAQTriggerLevel;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ pre-trigger samples.                                 ********************************************** */
+int &NIDAQmxTriggerConfig::getDAQPreTriggerSamples() {
+    return DAQPreTriggerSamples;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the DAQ post-trigger samples.                                ********************************************** */
+int &NIDAQmxTriggerConfig::getDAQPostTriggerSamples() {
+    return DAQPostTriggerSamples;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Check whether the task is triggered.                             ********************************************** */
+bool NIDAQmxTriggerConfig::isTriggered() const {
+    return (!DAQTriggerType.empty()) && (DAQTriggerType != "None");
+}
+/* *********************************************************************************************************************** */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+
+#include "NIDAQmxWindowStatistics.h"
+
+#include <cmath>
+
+using nidaqmx::NIDAQmxWindowStatistics;
+using nidaqmx::NIDAQmxStatistics;
+using std::vector;
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default constructor.                                             ********************************************** */
+NIDAQmxWindowStatistics::NIDAQmxWindowStatistics(const size_t &aNChannels, const size_t &aWindowScans)
+    : nChannels(aNChannels)
+      , windowScans(aWindowScans > 0 ? aWindowScans : 1)
+      , count(0)
+      , ready(false) {
+    NIDAQmxStatistics *windows[] = {&current, &completed};
+    for (size_t i = 0; i < 2; ++i) {
+        windows[i]->nScans = 0;
+        windows[i]->min.resize(nChannels);
+        windows[i]->max.resize(nChannels);
+        windows[i]->mean.resize(nChannels);
+        windows[i]->rms.resize(nChannels);
+        windows[i]->variance.resize(nChannels);
+    }
+
+    resetWindow();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Process a block of sensor values.                                ********************************************** */
+void NIDAQmxWindowStatistics::processBlock(const vector<double> &i_values) {
+    size_t nScans = i_values.size() / nChannels;
+
+    double *mn = &current.min[0];
+    double *mx = &current.max[0];
+    double *mean = &current.mean[0];
+    double *m2 = &current.variance[0];
+
+    for (size_t s = 0; s < nScans; ++s) {
+        const double *x = &i_values[s * nChannels];
+
+        // Welford update, the scan count is shared by all channels
+        ++count;
+        double invCount = 1.0 / count;
+        for (size_t j = 0; j < nChannels; ++j) {
+            double delta = x[j] - mean[j];
+            mean[j] += delta * invCount;
+            m2[j] += delta * (x[j] - mean[j]);
+            mn[j] = (x[j] < mn[j]) ? x[j] : mn[j];
+            mx[j] = (x[j] > mx[j]) ? x[j] : mx[j];
+        }
+
+        if (count == windowScans) {
+            // Finalise the window
+            for (size_t j = 0; j < nChannels; ++j) {
+                current.variance[j] = m2[j] * invCount;
+                current.rms[j] = std::sqrt(current.variance[j] + mean[j] * mean[j]);
+            }
+            current.nScans = count;
+
+            current.min.swap(completed.min);
+            current.max.swap(completed.max);
+            current.mean.swap(completed.mean);
+            current.rms.swap(completed.rms);
+            current.variance.swap(completed.variance);
+            completed.nScans = current.nScans;
+            ready = true;
+
+            resetWindow();
+            mn = &current.min[0];
+            mx = &current.max[0];
+            mean = &current.mean[0];
+            m2 = &current.variance[0];
+        }
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Discard the accumulated values.                                  ********************************************** */
+void NIDAQmxWindowStatistics::reset(void) {
+    resetWindow();
+    ready = false;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Collect the statistics of the last complete window.              ********************************************** */
+bool NIDAQmxWindowStatistics::popStatistics(NIDAQmxStatistics &o_statistics) {
+    if (!ready) {
+        return false;
+    }
+
+    o_statistics = completed;
+    ready = false;
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Start a new window.                                              ********************************************** */
+void NIDAQmxWindowStatistics::resetWindow(void) {
+    count = 0;
+    current.nScans = 0;
+    for (size_t j = 0; j < nChannels; ++j) {
+        current.min[j] = HUGE_VAL;
+        current.max[j] = -HUGE_VAL;
+        current.mean[j] = 0.0;
+        current.rms[j] = 0.0;
+        current.variance[j] = 0.0;
+    }
+}
+/* *********************************************************************************************************************** */
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+#include "NIDAQmxWorkerPool.h"
+
+using nidaqmx::NIDAQmxJob;
+using nidaqmx::NIDAQmxStrand;
+using nidaqmx::NIDAQmxWorkerPool;
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default Constructor.                                             ********************************************** */
+NIDAQmxWorkerPool::NIDAQmxWorkerPool(const size_t &aNWorkers) : nextQueue(0), nQueued(0), stopping(false) {
+    for (size_t i = 0; i < aNWorkers; ++i) {
+        queues.push_back(new Queue());
+    }
+    for (size_t i = 0; i < aNWorkers; ++i) {
+        workers.push_back(std::thread(&NIDAQmxWorkerPool::run, this, i));
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default Destructor.                                              ********************************************** */
+NIDAQmxWorkerPool::~NIDAQmxWorkerPool(void) {
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        stopping.store(true, std::memory_order_release);
+    }
+    idleCondition.notify_all();
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    for (size_t i = 0; i < queues.size(); ++i) {
+        delete queues[i];
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the process-wide pool.                                       ********************************************** */
+NIDAQmxWorkerPool &NIDAQmxWorkerPool::instance(void) {
+    static NIDAQmxWorkerPool pool(std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 2);
+    return pool;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the number of workers.                                       ********************************************** */
+size_t NIDAQmxWorkerPool::getNWorkers(void) const {
+    return workers.size();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Submit a job.                                                    ********************************************** */
+void NIDAQmxWorkerPool::submit(NIDAQmxJob *i_job) {
+    // Spread the jobs over the queues, idle workers steal them from busy ones
+    Queue &queue = *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+
+    // Counted before it is pushed, so that a worker taking it at once cannot bring the count below zero
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        nQueued.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(i_job);
+    }
+    idleCondition.notify_one();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Take or steal a job.                                             ********************************************** */
+NIDAQmxJob *NIDAQmxWorkerPool::takeJob(const size_t &i_worker) {
+    NIDAQmxJob *job = NULL;
+
+    // Own queue first, newest job while its data is still in cache
+    {
+        Queue &queue = *queues[i_worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        }
+    }
+
+    // Then steal the oldest job of the other workers
+    for (size_t i = 1; (job == NULL) && (i < queues.size()); ++i) {
+        Queue &queue = *queues[(i_worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+    }
+
+    if (job != NULL) {
+        nQueued.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Worker loop.                                                     ********************************************** */
+void NIDAQmxWorkerPool::run(size_t i_worker) {
+    while (!stopping.load(std::memory_order_acquire)) {
+        NIDAQmxJob *job = takeJob(i_worker);
+
+        if (job != NULL) {
+            job->run();
+        } else {
+            std::unique_lock<std::mutex> lock(idleMutex);
+            while ((nQueued.load(std::memory_order_acquire) == 0) && !stopping.load(std::memory_order_acquire)) {
+                idleCondition.wait(lock);
+            }
+        }
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Strand Default Constructor.                                      ********************************************** */
+NIDAQmxStrand::NIDAQmxStrand(void) : scheduled(false) {
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Strand Default Destructor.                                       ********************************************** */
+NIDAQmxStrand::~NIDAQmxStrand(void) {
+    drain();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Post a job to the strand.                                        ********************************************** */
+void NIDAQmxStrand::post(NIDAQmxJob *i_job) {
+    bool submit = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(i_job);
+        if (!scheduled) {
+            scheduled = true;
+            submit = true;
+        }
+    }
+
+    if (submit) {
+        NIDAQmxWorkerPool::instance().submit(this);
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the number of pending jobs.                                  ********************************************** */
+size_t NIDAQmxStrand::getNPending(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Wait for the posted jobs.                                        ********************************************** */
+void NIDAQmxStrand::drain(void) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (scheduled) {
+        idleCondition.wait(lock);
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Run the posted jobs.                                             ********************************************** */
+void NIDAQmxStrand::run(void) {
+    for (;;) {
+        NIDAQmxJob *job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (jobs.empty()) {
+                scheduled = false;
+                idleCondition.notify_all();
+                return;
+            }
+            job = jobs.front();
+        }
+
+        job->run();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.pop_front();
+        }
+
+        // Only once it is off the queue, the job may be posted again as soon as it is released
+        job->release();
+    }
+}
+/* *********************************************************************************************************************** */
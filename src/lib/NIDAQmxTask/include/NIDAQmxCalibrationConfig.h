@@ -25,11 +25,43 @@
 #ifndef __NIDAQMXCALIBRATIONCONFIG_H__
 #define __NIDAQMXCALIBRATIONCONFIG_H__
 
+#include <cstddef>
 #include <vector>
 
 #include "NIDAQmxTypedefs.h"
 
 namespace nidaqmx {
+    /**
+     * The layouts in which the composed affine matrix is applied.
+     */
+    enum NIDAQmxAffineLayout {
+        AffineBlocks,
+        AffineSparse
+    };
+
+    /**
+     * A dense block of the composed affine matrix.
+     * Every row of the block only uses the columns of the block, all the other coefficients of these rows are zero.
+     */
+    struct NIDAQmxAffineBlock {
+        /**
+         * The first row and the number of rows of the block.
+         */
+        size_t firstRow;
+        size_t nRows;
+
+        /**
+         * The first column and the number of columns of the block.
+         */
+        size_t firstColumn;
+        size_t nColumns;
+
+        /**
+         * The position of the block coefficients, stored row after row, in the packed coefficients.
+         */
+        size_t offset;
+    };
+
     /**
     * \class NIDAQmxCalibrationConfig
     *
@@ -41,6 +73,20 @@ namespace nidaqmx {
     * It contains all those parameters which are dependent on the sensor to be acquired.
     * These include the calibration scales, the calibration matrix, etc.
     *
+    * The real sensor values are computed from the analog values x as
+    *     y = T (diag(1/scales) C x - bias)
+    * where C is the calibration matrix and T an optional output transform, e.g. the wrench transform to a tool frame.
+    * The calibration matrix may be rectangular: with N channels and M rows it computes M outputs, one per scale,
+    * so that auxiliary channels acquired on the same device (temperature, excitation monitor, etc.) need not be calibrated.
+    * The bias then has M elements and the output transform is M x M.
+    * All these terms are composed into a single affine map y = A x + b when the configuration is built,
+    * so that computing each output value costs one multiply-add per input channel.
+    *
+    * The structure of the composed matrix is analysed at the same time, so that no work is spent on its zero coefficients.
+    * Consecutive rows using the same span of columns are grouped into dense blocks: a dense matrix is a single block,
+    * while several six-axis sensors read by one device give one 6x6 block per sensor.
+    * If the blocks would still hold mostly zeros the matrix is instead stored in compressed sparse row form.
+    *
     * The configuration of a NIDAQmxTask object is a fairly cumbersome taks.
     * This class was created to simplify the interface for the end-user while maintaining a most flexible functionality.
     *
@@ -70,9 +116,60 @@ namespace nidaqmx {
             std::vector<double> DAQSensorCalibScales;
 
             /**
-             * The DAQ sensor calibration matrix.
+             * The DAQ sensor calibration matrix, one row per output and one column per channel.
              */
             DoubleMatrix2D DAQSensorCalibMatrix;
+
+            /**
+             * The bias subtracted from the scaled values, before the output transform.
+             * An empty vector means no bias.
+             */
+            std::vector<double> DAQSensorBias;
+
+            /**
+             * The output transform applied last.
+             * An empty matrix means the identity.
+             */
+            DoubleMatrix2D DAQOutputTransform;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* Composed affine map                          ******* */
+            /**
+             * The composed matrix A = T diag(1/scales) C, stored row after row.
+             */
+            std::vector<double> DAQAffineMatrix;
+
+            /**
+             * The composed offset b = -T bias.
+             */
+            std::vector<double> DAQAffineOffset;
+
+            /**
+             * The layout used to apply the composed matrix.
+             */
+            NIDAQmxAffineLayout DAQAffineLayout;
+
+            /**
+             * The dense blocks of the composed matrix, for the AffineBlocks layout.
+             */
+            std::vector<nidaqmx::NIDAQmxAffineBlock> DAQAffineBlocks;
+
+            /**
+             * The non-zero coefficients, packed block after block or row after row depending on the layout.
+             */
+            std::vector<double> DAQAffineCoefficients;
+
+            /**
+             * The column of each non-zero coefficient, for the AffineSparse layout.
+             */
+            std::vector<size_t> DAQAffineColumns;
+
+            /**
+             * The position of the first coefficient of each row, plus the total, for the AffineSparse layout.
+             */
+            std::vector<size_t> DAQAffineRowStarts;
             /* ************************************************************ */
 
         public:
@@ -80,8 +177,11 @@ namespace nidaqmx {
              * Default constructor.
              * \param aDAQSensorCalibScales The sensor calibration scales
              * \param aDAQSensorCalibMatrix The sensor calibration matrix
+             * \param aDAQSensorBias The bias subtracted from the scaled values (empty for none)
+             * \param aDAQOutputTransform The output transform (empty for the identity)
              */
-            NIDAQmxCalibrationConfig(const std::vector<double> &aDAQSensorCalibScales, const DoubleMatrix2D &aDAQSensorCalibMatrix);
+            NIDAQmxCalibrationConfig(const std::vector<double> &aDAQSensorCalibScales, const DoubleMatrix2D &aDAQSensorCalibMatrix,
+                    const std::vector<double> &aDAQSensorBias = std::vector<double>(), const DoubleMatrix2D &aDAQOutputTransform = DoubleMatrix2D());
 
             /* ************************************************************ */
             /* ******* Getters.                                     ******* */
@@ -96,7 +196,75 @@ namespace nidaqmx {
              * \returns A DoubleMatrix2D object containing the calibration matrix
              */
             DoubleMatrix2D &getDAQSensorCalibMatrix();
+
+            /**
+             * Get the DAQ sensor bias.
+             * \returns An std::vector<double> containing the bias, empty if none
+             */
+            std::vector<double> &getDAQSensorBias();
+
+            /**
+             * Get the output transform.
+             * \returns A DoubleMatrix2D object containing the output transform, empty for the identity
+             */
+            DoubleMatrix2D &getDAQOutputTransform();
+
+            /**
+             * Get the composed affine matrix.
+             * \returns An std::vector<double> containing the matrix A, row after row
+             */
+            std::vector<double> &getDAQAffineMatrix();
+
+            /**
+             * Get the composed affine offset.
+             * \returns An std::vector<double> containing the offset b
+             */
+            std::vector<double> &getDAQAffineOffset();
+
+            /**
+             * Get the number of outputs, i.e. the number of rows of the calibration matrix.
+             */
+            size_t getDAQNOutputs();
+
+            /**
+             * Get the layout used to apply the composed matrix.
+             */
+            NIDAQmxAffineLayout getDAQAffineLayout();
+
+            /**
+             * Get the dense blocks of the composed matrix.
+             * \returns The blocks, empty unless the layout is AffineBlocks
+             */
+            std::vector<nidaqmx::NIDAQmxAffineBlock> &getDAQAffineBlocks();
+
+            /**
+             * Get the packed coefficients of the composed matrix.
+             */
+            std::vector<double> &getDAQAffineCoefficients();
+
+            /**
+             * Get the column of each packed coefficient.
+             * \returns The columns, empty unless the layout is AffineSparse
+             */
+            std::vector<size_t> &getDAQAffineColumns();
+
+            /**
+             * Get the position of the first packed coefficient of each row.
+             * \returns The row starts followed by the number of coefficients, empty unless the layout is AffineSparse
+             */
+            std::vector<size_t> &getDAQAffineRowStarts();
             /* ************************************************************ */
+
+        private:
+            /**
+             * Compose the calibration, scales, bias and output transform into the affine map.
+             */
+            void composeAffine(void);
+
+            /**
+             * Choose the layout of the composed matrix and pack its coefficients accordingly.
+             */
+            void packAffine(void);
     };
 }
 
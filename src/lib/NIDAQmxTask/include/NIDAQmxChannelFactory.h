@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXCHANNELFACTORY_H__
+#define __NIDAQMXCHANNELFACTORY_H__
+
+#include <map>
+#include <string>
+
+#include "NIDAQmxConstants.h"
+
+namespace nidaqmx {
+    /**
+     * The settings shared by a group of physical channels created with a single driver call.
+     */
+    struct NIDAQmxChannelSpec {
+        /**
+         * The comma-separated list of physical channels, including the device name.
+         */
+        std::string physicalChannels;
+
+        /**
+         * The NIDAQmx terminal configuration constant.
+         */
+        int terminalConfig;
+
+        /**
+         * The minimum value to be read, in the channel units.
+         */
+        double minVal;
+
+        /**
+         * The maximum value to be read, in the channel units.
+         */
+        double maxVal;
+
+        /**
+         * The encoder scale: pulses per revolution for angular encoders, distance per pulse for linear encoders.
+         */
+        double scale;
+    };
+
+    /**
+     * The kinds of channels, which cannot be mixed within one NIDAQmx task.
+     */
+    enum NIDAQmxChannelKind {
+        AnalogInput,
+        CounterInput
+    };
+
+    /**
+     * A function creating channels of a given type.
+     * \param i_taskHandle The task to which the channels are added
+     * \param i_spec The channel settings
+     * \param i_param The type-specific parameter registered with the creator (units, thermocouple type, etc.)
+     * \returns The NIDAQmx error code
+     */
+    typedef int32 (*NIDAQmxChannelCreator)(TaskHandle i_taskHandle, const nidaqmx::NIDAQmxChannelSpec &i_spec, int i_param);
+
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxChannelFactory
+    *
+    * \brief The NIDAQmxChannelFactory creates the DAQ channels of a task according to their channel type.
+    *
+    *
+    * \section intro_sec Description
+    * The NIDAQmxChannelFactory maps the channel type names used in the configuration file to the NIDAQmx function creating them.
+    * The following analog input types are registered by default:
+    *     - AIVoltage: voltage measurement (Volts)
+    *     - AICurrent: current measurement (Amps), only available with NIDAQmx
+    *     - AIThermocoupleB, AIThermocoupleE, AIThermocoupleJ, AIThermocoupleK, AIThermocoupleN, AIThermocoupleR, AIThermocoupleS, AIThermocoupleT:
+    *       thermocouple temperature measurement (degrees Celsius) with built-in cold-junction compensation
+    *
+    * All of these are analog input channels and may be mixed within one task.
+    * They share the task sample clock and are read as one interleaved block of values, each channel in its own units.
+    *
+    * The following counter input types are also registered:
+    *     - CIAngEncoder: X4 quadrature angular encoder (degrees), the scale is the number of pulses per revolution
+    *     - CILinEncoder: X4 quadrature linear encoder (meters), the scale is the distance per pulse
+    *     - CICountEdges: rising edge counter (ticks)
+    *
+    * Counter channels cannot share a task with analog inputs, getChannelKind() tells the two apart.
+    *
+    * Further channel types can be added with registerChannelType().
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxChannelFactory.h.
+    */
+    class NIDAQmxChannelFactory {
+        private:
+            /**
+             * A registered channel type.
+             */
+            struct Entry {
+                NIDAQmxChannelCreator creator;
+                int param;
+                NIDAQmxChannelKind kind;
+            };
+
+            /**
+             * The registered channel types, indexed by name.
+             */
+            std::map<std::string, Entry> channelTypes;
+
+        public:
+            /**
+             * Default constructor.
+             * Registers the default analog and counter input channel types.
+             */
+            NIDAQmxChannelFactory();
+
+            /**
+             * Register a channel type.
+             * \param i_name The channel type name used in the configuration
+             * \param i_creator The function creating the channels
+             * \param i_param The type-specific parameter passed to the creator
+             * \param i_kind The kind of channel created
+             */
+            void registerChannelType(const std::string &i_name, NIDAQmxChannelCreator i_creator, int i_param, NIDAQmxChannelKind i_kind = AnalogInput);
+
+            /**
+             * Check whether a channel type is registered.
+             * \param i_name The channel type name
+             */
+            bool hasChannelType(const std::string &i_name) const;
+
+            /**
+             * Get the kind of a registered channel type.
+             * \param i_name The channel type name
+             */
+            NIDAQmxChannelKind getChannelKind(const std::string &i_name) const;
+
+            /**
+             * Create channels of the given type.
+             * \param i_taskHandle The task to which the channels are added
+             * \param i_name The channel type name
+             * \param i_spec The channel settings
+             * \returns The NIDAQmx error code
+             */
+            int32 createChannels(TaskHandle i_taskHandle, const std::string &i_name, const nidaqmx::NIDAQmxChannelSpec &i_spec) const;
+    };
+}
+
+#endif
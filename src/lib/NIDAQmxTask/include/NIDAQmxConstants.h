@@ -43,7 +43,8 @@ namespace nidaqmx {
     public:
         enum Type  {
             Volts = DAQmx_Val_Volts,
-            Amps = DAQmx_Val_Amps
+            Amps = DAQmx_Val_Amps,
+            DegC = DAQmx_Val_DegC
         };
 
         Type t_;
@@ -65,7 +66,9 @@ namespace nidaqmx {
     public:
         enum Type  {
             Default = DAQmx_Val_Cfg_Default,
-            Diff = DAQmx_Val_Diff
+            Diff = DAQmx_Val_Diff,
+            RSE = DAQmx_Val_RSE,
+            NRSE = DAQmx_Val_NRSE
         };
 
         Type t_;
@@ -77,5 +80,27 @@ namespace nidaqmx {
        template<typename T>
        operator T () const;
     };
+
+
+    /**
+     * Enum to provide interface conversion for NIDAQmx trigger edges.
+     * The same constants are used for digital edges and analog slopes.
+     */
+    struct DAQTriggerSlope {
+    public:
+        enum Type  {
+            Rising = DAQmx_Val_Rising,
+            Falling = DAQmx_Val_Falling
+        };
+
+        Type t_;
+        DAQTriggerSlope(Type t) : t_(t) {}
+        operator Type () const {return t_;}
+
+    private:
+       //prevent automatic conversion for any other built-in types such as bool, int, etc
+       template<typename T>
+       operator T () const;
+    };
 }
 #endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXCOUNTERCONFIG_H__
+#define __NIDAQMXCOUNTERCONFIG_H__
+
+#include <string>
+#include <vector>
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxCounterConfig
+    *
+    * \brief The NIDAQmxCounterConfig is the configuration object for the counter channels.
+    *
+    *
+    * \section intro_sec Description
+    * The NIDAQmxCounterConfig is the configuration object for the counter channels (encoders, edge counters) acquired alongside the analog channels.
+    * Each counter channel runs in its own NIDAQmx task clocked by the analog input sample clock, so that counter sample k is taken together with analog scan k.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxCounterConfig.h.
+    */
+    class NIDAQmxCounterConfig {
+        private:
+            /* ************************************************************ */
+            /* ******* DAQ counter attributes                       ******* */
+            /**
+             * The DAQ counters to acquire.
+             */
+            std::vector<std::string> DAQCounterChannels;
+
+            /**
+             * The DAQ counter channel types.
+             */
+            std::vector<std::string> DAQCounterChannelTypes;
+
+            /**
+             * The DAQ counter scales (pulses per revolution, distance per pulse, etc.).
+             */
+            std::vector<double> DAQCounterScales;
+            /* ************************************************************ */
+
+        public:
+            /**
+             * Default constructor.
+             * \param aDAQCounterChannels The DAQ counters to acquire
+             * \param aDAQCounterChannelTypes The DAQ counter channel types
+             * \param aDAQCounterScales The DAQ counter scales
+             */
+            NIDAQmxCounterConfig(const std::vector<std::string> &aDAQCounterChannels, const std::vector<std::string> &aDAQCounterChannelTypes,
+                const std::vector<double> &aDAQCounterScales);
+
+            /* ************************************************************ */
+            /* ******* Getters.                                     ******* */
+
+            /**
+             * Get the list of DAQ counters to acquire.
+             * \returns An std::vector<std::string> containing the list of DAQ counters.
+             */
+            std::vector<std::string> &getDAQCounterChannels();
+
+            /**
+             * Get the DAQ counter channel types.
+             * \returns An std::vector<std::string> containing the DAQ counter channel types.
+             */
+            std::vector<std::string> &getDAQCounterChannelTypes();
+
+            /**
+             * Get the DAQ counter scales.
+             * \returns An std::vector<double> containing the DAQ counter scales.
+             */
+            std::vector<double> &getDAQCounterScales();
+            /* ************************************************************ */
+    };
+}
+
+#endif
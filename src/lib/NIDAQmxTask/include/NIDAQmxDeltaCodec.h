@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+
+
+#ifndef __NIDAQMXDELTACODEC_H__
+#define __NIDAQMXDELTACODEC_H__
+
+#include <cstddef>
+
+#include "NIDAQmxConstants.h"
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxDeltaCodec
+    *
+    * \brief The NIDAQmxDeltaCodec losslessly compresses blocks of 16-bit values, such as quantised sensor values.
+    *
+    *
+    * \section intro_sec Description
+    * Consecutive scans of a sensor differ by a few steps only, so their differences need far fewer than 16 bits.
+    * Each channel of a block is encoded on its own:
+    *     - the first scan is kept as is and each following scan is replaced by its difference with the previous one
+    *     - the differences are zigzag mapped to unsigned integers (0, -1, 1, -2, ... become 0, 1, 2, 3, ...)
+    *     - they are bit-packed in frames of frameSize values, each frame using the width of its largest value,
+    *       stored in the byte preceding it
+    *
+    * Blocks are encoded independently of each other, so a dropped block does not prevent decoding the next ones.
+    * Both directions are single passes with no branch depending on the data within a frame.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxDeltaCodec.h.
+    */
+    class NIDAQmxDeltaCodec {
+        public:
+            /**
+             * The number of values sharing a bit width.
+             */
+            static const size_t frameSize = 128;
+
+            /**
+             * Get the largest size of an encoded block.
+             * \param i_nScans The number of scans
+             * \param i_nChannels The number of values per scan
+             * \returns The size in bytes
+             */
+            static size_t maxEncodedSize(const size_t &i_nScans, const size_t &i_nChannels);
+
+            /**
+             * Encode a block.
+             * \param i_values The values, scan after scan
+             * \param i_nScans The number of scans
+             * \param i_nChannels The number of values per scan
+             * \param o_bytes The encoded block, at least maxEncodedSize() bytes
+             * \returns The size of the encoded block in bytes
+             */
+            static size_t encode(const int16 *i_values, const size_t &i_nScans, const size_t &i_nChannels, unsigned char *o_bytes);
+
+            /**
+             * Decode a block.
+             * \param i_bytes The encoded block
+             * \param i_size The size of the encoded block in bytes
+             * \param i_nScans The number of scans
+             * \param i_nChannels The number of values per scan
+             * \param o_values The values, scan after scan
+             * \returns false if the encoded block is truncated or corrupted
+             */
+            static bool decode(const unsigned char *i_bytes, const size_t &i_size, const size_t &i_nScans, const size_t &i_nChannels, int16 *o_values);
+    };
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+
+
+#ifndef __NIDAQMXENVELOPE_H__
+#define __NIDAQMXENVELOPE_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "NIDAQmxStage.h"
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxEnvelope
+    *
+    * \brief The NIDAQmxEnvelope decimates the sensor values to display rate, keeping the minimum and maximum of every channel.
+    *
+    *
+    * \section intro_sec Description
+    * The NIDAQmxEnvelope splits the scans into consecutive bins of a fixed number of scans
+    * and reduces every bin to the minimum and the maximum value of each channel, computed in a single pass over each block.
+    * Unlike plain decimation, the envelope keeps the spikes shorter than a bin visible on a scope.
+    *
+    * Every complete bin is appended to the envelopes collected with popEnvelopes(),
+    * as the minimum of every channel followed by the maximum of every channel.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxEnvelope.h.
+    */
+    class NIDAQmxEnvelope : public NIDAQmxStage {
+        private:
+            /**
+             * The number of channels per scan.
+             */
+            size_t nChannels;
+
+            /**
+             * The number of scans per bin.
+             */
+            size_t binScans;
+
+            /**
+             * The number of scans in the current bin.
+             */
+            size_t binFill;
+
+            /**
+             * The minimum and maximum of each channel in the current bin.
+             */
+            std::vector<double> binMin;
+            std::vector<double> binMax;
+
+            /**
+             * The complete bins not yet collected.
+             */
+            std::vector<double> envelopes;
+
+            /**
+             * Start a new bin.
+             */
+            void resetBin(void);
+
+        public:
+            /**
+             * Default constructor.
+             * \param aNChannels The number of channels per scan
+             * \param aBinScans The number of scans reduced to one envelope value
+             */
+            NIDAQmxEnvelope(const size_t &aNChannels, const size_t &aBinScans);
+
+            /**
+             * Process a block of sensor values.
+             * \param i_values The sensor values, interleaved by scan
+             */
+            virtual void processBlock(const std::vector<double> &i_values);
+
+            /**
+             * Discard the values accumulated so far.
+             */
+            virtual void reset(void);
+
+            /**
+             * Collect the complete bins.
+             * The bins are swapped with the given vector, so passing the same vector every time avoids any allocation.
+             * \param o_envelopes The bins, each made of the minimum then the maximum of every channel
+             * \returns true if at least one bin was collected
+             */
+            bool popEnvelopes(std::vector<double> &o_envelopes);
+
+            /**
+             * Get the number of scans per bin.
+             * \returns The number of scans reduced to one envelope value
+             */
+            size_t getBinScans(void) const;
+
+            /**
+             * Get the number of scans accumulated in the current bin, which is not complete yet.
+             * The last collected bin thus ended this number of scans before the last scan processed.
+             * \returns The number of scans in the current bin
+             */
+            size_t getBinFill(void) const;
+    };
+}
+
+#endif
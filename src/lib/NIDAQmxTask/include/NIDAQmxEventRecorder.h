@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXEVENTRECORDER_H__
+#define __NIDAQMXEVENTRECORDER_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "NIDAQmxStage.h"
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxEventRecorder
+    *
+    * \brief The NIDAQmxEventRecorder captures the scans surrounding a threshold crossing.
+    *
+    *
+    * \section intro_sec Description
+    * The NIDAQmxEventRecorder keeps the last pre-trigger scans in a preallocated ring.
+    * Every block is tested against a per-channel threshold on the absolute value with a single branch-free pass, which the compiler vectorises;
+    * the crossing scan is only searched for in blocks where the test succeeds.
+    *
+    * On a crossing the ring is copied into the snapshot and the following post-trigger scans are appended, possibly over several blocks.
+    * The complete snapshot is then handed over with popSnapshot().
+    * While a snapshot is being captured or has not been collected, further crossings are ignored.
+    *
+    * A channel with a threshold of zero or less is never checked.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxEventRecorder.h.
+    */
+    class NIDAQmxEventRecorder : public NIDAQmxStage {
+        private:
+            /* ************************************************************ */
+            /* ******* Configuration                                ******* */
+            /**
+             * The number of channels per scan.
+             */
+            size_t nChannels;
+
+            /**
+             * The number of scans kept before the crossing.
+             */
+            size_t preScans;
+
+            /**
+             * The number of scans captured from the crossing onwards.
+             */
+            size_t postScans;
+
+            /**
+             * The per-channel thresholds, repeated for as many scans as the largest block seen.
+             * Disabled channels hold infinity.
+             */
+            std::vector<double> thresholdBlock;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* Pre-trigger ring                             ******* */
+            /**
+             * The last preScans scans.
+             */
+            std::vector<double> ring;
+
+            /**
+             * The ring slot the next scan is written to.
+             */
+            size_t ringHead;
+
+            /**
+             * The number of valid scans in the ring.
+             */
+            size_t ringFill;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* Snapshot                                     ******* */
+            /**
+             * The snapshot being captured or waiting to be collected.
+             */
+            std::vector<double> snapshot;
+
+            /**
+             * The number of scans preceding the crossing in the snapshot.
+             */
+            size_t snapshotPreScans;
+
+            /**
+             * The number of post-trigger scans still to be captured.
+             */
+            size_t remainingScans;
+
+            /**
+             * The channel which crossed its threshold.
+             */
+            size_t triggerChannel;
+
+            /**
+             * Whether a snapshot is being captured.
+             */
+            bool capturing;
+
+            /**
+             * Whether a complete snapshot is waiting to be collected.
+             */
+            bool ready;
+            /* ************************************************************ */
+
+        public:
+            /**
+             * Default constructor.
+             * \param aNChannels The number of channels per scan
+             * \param aPreScans The number of scans kept before the crossing
+             * \param aPostScans The number of scans captured from the crossing onwards
+             * \param aThresholds The threshold on the absolute value of each channel
+             */
+            NIDAQmxEventRecorder(const size_t &aNChannels, const size_t &aPreScans, const size_t &aPostScans, const std::vector<double> &aThresholds);
+
+            /**
+             * Process a block of sensor values.
+             * \param i_values The sensor values, interleaved by scan
+             */
+            virtual void processBlock(const std::vector<double> &i_values);
+
+            /**
+             * Discard the values accumulated so far.
+             */
+            virtual void reset(void);
+
+            /**
+             * Collect a complete snapshot.
+             * The snapshot is swapped with the given vector, so passing the same vector every time avoids any allocation.
+             * \param o_scans The snapshot scans, interleaved by scan
+             * \param o_preScans The number of scans preceding the crossing
+             * \param o_triggerChannel The channel which crossed its threshold
+             * \returns true if a snapshot was collected
+             */
+            bool popSnapshot(std::vector<double> &o_scans, size_t &o_preScans, size_t &o_triggerChannel);
+
+        private:
+            /**
+             * Find the first scan crossing a threshold.
+             * \param i_values The block values
+             * \param i_first The first scan to test
+             * \param i_nScans The number of scans to test
+             * \returns The index of the crossing scan, or i_first + i_nScans if there is none
+             */
+            size_t findCrossing(const std::vector<double> &i_values, const size_t &i_first, const size_t &i_nScans);
+
+            /**
+             * Push scans into the pre-trigger ring.
+             * \param i_values The block values
+             * \param i_first The first scan to push
+             * \param i_nScans The number of scans to push
+             */
+            void pushRing(const std::vector<double> &i_values, const size_t &i_first, const size_t &i_nScans);
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+
+
+/*
+ * Helper functions used across the nidaqmx namespace.
+ */
+
+#ifndef __NIDAQMXFUNCTIONS_H__
+#define __NIDAQMXFUNCTIONS_H__
+
+#include <chrono>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace nidaqmx {
+    /* ************************************************************ */
+    /* ******* Clock                                        ******* */
+    /**
+     * Get the time of the monotonic clock, which is used for every interval measured in the nidaqmx namespace.
+     * \returns The time in nanoseconds since an arbitrary origin
+     */
+    inline uint64_t monotonicNanoseconds(void) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Get the time of the monotonic clock in seconds.
+     * \returns The time in seconds since the origin of monotonicNanoseconds()
+     */
+    inline double monotonicNow(void) {
+        return monotonicNanoseconds() * 1e-9;
+    }
+    /* ************************************************************ */
+
+
+    /* ************************************************************ */
+    /* ******* Block layout                                 ******* */
+    /**
+     * Repeat per-channel values over a block, so that the block can be tested against them in one flat loop.
+     * The first i_nChannels elements of io_values hold the value of each channel; the vector is grown by repeating them
+     * until it covers at least i_nValues interleaved values, and left untouched if it already does.
+     * \param io_values The per-channel values, repeated in place
+     * \param i_nChannels The number of channels
+     * \param i_nValues The number of values the block must cover
+     */
+    inline void repeatChannelValues(std::vector<double> &io_values, const size_t &i_nChannels, const size_t &i_nValues) {
+        size_t oldSize = io_values.size();
+        if (oldSize >= i_nValues) {
+            return;
+        }
+
+        io_values.resize(i_nValues);
+        for (size_t i = oldSize; i < i_nValues; ++i) {
+            io_values[i] = io_values[i % i_nChannels];
+        }
+    }
+    /* ************************************************************ */
+}
+
+#endif
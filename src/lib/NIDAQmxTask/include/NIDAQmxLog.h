@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXLOG_H__
+#define __NIDAQMXLOG_H__
+
+#include <string>
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxLog
+    *
+    * \brief The NIDAQmxLog is the leveled logging facility used by the NIDAQmxTask library.
+    *
+    *
+    * \section intro_sec Description
+    * Messages below the configured verbosity level are discarded before being formatted.
+    * The remaining messages are copied into a fixed-size lock-free queue and written to the terminal by a background thread,
+    * so the acquisition thread never waits on terminal I/O.
+    * If the queue is full the message is dropped and counted; the number of dropped messages is reported with the next message written.
+    *
+    * Messages logged on every block should go through a NIDAQmxLogLimiter so that they are written at most once per interval.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxLog.h.
+    */
+    class NIDAQmxLog {
+        public:
+            /**
+             * The message levels, in increasing order of verbosity.
+             */
+            enum Level {
+                Error = 0,
+                Warning = 1,
+                Info = 2,
+                Debug = 3
+            };
+
+            /**
+             * Set the verbosity level.
+             * \param i_level The most verbose level that is written
+             */
+            static void setLevel(Level i_level);
+
+            /**
+             * Set the verbosity level from its name (error, warning, info or debug).
+             * \param i_level The level name
+             * \returns false if the name is not a valid level
+             */
+            static bool setLevel(const std::string &i_level);
+
+            /**
+             * Check whether messages of the given level are written.
+             * \param i_level The message level
+             */
+            static bool isEnabled(Level i_level);
+
+            /**
+             * Queue a printf-style message for writing.
+             * This never blocks: if the queue is full the message is dropped.
+             * \param i_level The message level
+             * \param i_format The printf-style format string
+             */
+            static void log(Level i_level, const char *i_format, ...)
+#ifdef __GNUC__
+                __attribute__((format(printf, 2, 3)))
+#endif
+                ;
+
+            /**
+             * Write all the queued messages before returning.
+             */
+            static void flush(void);
+    };
+
+
+    /**
+     * Rate limiter for messages logged from the acquisition loop.
+     */
+    class NIDAQmxLogLimiter {
+        private:
+            /**
+             * The minimum time between two messages in seconds.
+             */
+            double minInterval;
+
+            /**
+             * The time the last message was allowed.
+             */
+            double lastTime;
+
+            /**
+             * The number of messages refused since the last one allowed.
+             */
+            unsigned int suppressed;
+
+        public:
+            /**
+             * Default constructor.
+             * \param aMinInterval The minimum time between two messages in seconds
+             */
+            NIDAQmxLogLimiter(const double &aMinInterval);
+
+            /**
+             * Check whether a message may be logged now.
+             * \param o_suppressed The number of messages refused since the last one allowed
+             * \returns true if the message may be logged
+             */
+            bool allow(unsigned int &o_suppressed);
+    };
+}
+
+#endif
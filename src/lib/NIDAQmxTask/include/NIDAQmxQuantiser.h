@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+
+
+#ifndef __NIDAQMXQUANTISER_H__
+#define __NIDAQMXQUANTISER_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "NIDAQmxConstants.h"
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxQuantiser
+    *
+    * \brief The NIDAQmxQuantiser converts sensor values to 16-bit integers for transmission over slow links.
+    *
+    *
+    * \section intro_sec Description
+    * Each channel has a range, mapped onto the 16-bit integers from -32767 to 32767 by a scale and an offset:
+    * a value v is sent as q = round((v - offset) / scale) and recovered as offset + scale * q.
+    * Values outside the range are clamped to it.
+    *
+    * The ranges of the calibrated values are best derived from the ranges of the analog channels with affineRanges(),
+    * so that the quantisation step of each output is about the contribution of one ADC step to it.
+    *
+    * quantise() is a single branch-free pass over the block, which GCC vectorises at -O3 (the Release build).
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxQuantiser.h.
+    */
+    class NIDAQmxQuantiser {
+        private:
+            /**
+             * The number of channels per scan.
+             */
+            size_t nChannels;
+
+            /**
+             * The value of one quantisation step of each channel.
+             */
+            std::vector<double> scales;
+
+            /**
+             * The value of each channel sent as zero.
+             */
+            std::vector<double> offsets;
+
+            /**
+             * The offsets and inverse scales, repeated for as many scans as the largest block quantised.
+             */
+            std::vector<double> blockOffsets;
+            std::vector<double> blockInvScales;
+
+        public:
+            /**
+             * Default constructor.
+             * \param aMin The minimum value of each channel
+             * \param aMax The maximum value of each channel
+             */
+            NIDAQmxQuantiser(const std::vector<double> &aMin, const std::vector<double> &aMax);
+
+            /**
+             * Change the channel ranges.
+             * \param i_min The minimum value of each channel
+             * \param i_max The maximum value of each channel
+             */
+            void setRanges(const std::vector<double> &i_min, const std::vector<double> &i_max);
+
+            /**
+             * Quantise a block of values.
+             * \param i_values The values, interleaved by scan
+             * \param o_values The quantised values, as many as i_values
+             */
+            void quantise(const std::vector<double> &i_values, int16 *o_values);
+
+            /**
+             * Get the value of one quantisation step of each channel.
+             */
+            std::vector<double> &getScales(void);
+
+            /**
+             * Get the value of each channel sent as zero.
+             */
+            std::vector<double> &getOffsets(void);
+
+            /**
+             * Compute the ranges of the outputs of an affine map y = A x + b whose inputs lie within given ranges.
+             * \param i_matrix The matrix A, row after row, with one column per input
+             * \param i_offset The offset b, one value per output
+             * \param i_min The minimum value of each input
+             * \param i_max The maximum value of each input
+             * \param o_min The minimum value of each output
+             * \param o_max The maximum value of each output
+             */
+            static void affineRanges(const std::vector<double> &i_matrix, const std::vector<double> &i_offset,
+                    const std::vector<double> &i_min, const std::vector<double> &i_max, std::vector<double> &o_min, std::vector<double> &o_max);
+    };
+}
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXSIMULATOR_H__
+#define __NIDAQMXSIMULATOR_H__
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include "NIDAQmxConstants.h"
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxSimulator
+    *
+    * \brief The NIDAQmxSimulator stands in for a DAQ device, so that the acquisition can run without the hardware or the driver.
+    *
+    *
+    * \section intro_sec Description
+    * The simulated device acquires continuously on a clock following the monotonic time from start(),
+    * and hands out the scans acquired so far like a driver read of all the available samples.
+    * Each channel holds a sine wave of its own frequency with some uniform noise,
+    * centred within the channel range and never reaching the channel limits.
+    * The counters count one tick per scan, times their index plus one.
+    *
+    * Scans left unread for longer than the input buffer are lost, and the next read fails as the driver would on an overrun.
+    * Triggered acquisition is not simulated.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxSimulator.h.
+    */
+    class NIDAQmxSimulator {
+        private:
+            /**
+             * The centre, sine amplitude, noise amplitude and sine frequency (Hz) of each channel.
+             */
+            std::vector<double> centres;
+            std::vector<double> amplitudes;
+            std::vector<double> noiseAmplitudes;
+            std::vector<double> frequencies;
+
+            /**
+             * The sampling rate in Hz and the input buffer size in scans.
+             */
+            double samplingRate;
+            uInt64 bufferSize;
+
+            /**
+             * Whether the device is acquiring, the time it started and the number of scans read since.
+             */
+            bool running;
+            double startTime;
+            uInt64 scansRead;
+
+            /**
+             * The state of the noise generator.
+             */
+            uint32_t noiseState;
+
+        public:
+            /**
+             * Default constructor.
+             * \param aMinVals The minimum value of each channel
+             * \param aMaxVals The maximum value of each channel
+             */
+            NIDAQmxSimulator(const std::vector<double> &aMinVals, const std::vector<double> &aMaxVals);
+
+            /**
+             * Start acquiring.
+             * \param i_samplingRate The sampling rate in Hz
+             * \param i_bufferSize The input buffer size in scans
+             */
+            void start(const double &i_samplingRate, const int &i_bufferSize);
+
+            /**
+             * Stop acquiring, discarding the scans not read.
+             */
+            void stop(void);
+
+            /**
+             * Get the number of scans acquired but not read yet.
+             */
+            uInt64 getAvailableScans(void) const;
+
+            /**
+             * Read the scans available, without waiting for more.
+             * \param i_maxScans The largest number of scans to read
+             * \param o_data The values read, interleaved by scan
+             * \param o_readScans The number of scans read
+             * \returns false if unread scans were lost
+             */
+            bool read(const int &i_maxScans, double *o_data, int32 &o_readScans);
+
+            /**
+             * Get the counter values latched with the last scans read.
+             * \param i_nScans The number of scans
+             * \param i_nCounters The number of counters
+             * \param o_counter The counter values, interleaved by scan
+             */
+            void readCounters(const int &i_nScans, const size_t &i_nCounters, std::vector<double> &o_counter) const;
+    };
+}
+
+#endif
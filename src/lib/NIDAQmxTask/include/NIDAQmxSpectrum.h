@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXSPECTRUM_H__
+#define __NIDAQMXSPECTRUM_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "NIDAQmxStage.h"
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxSpectrum
+    *
+    * \brief The NIDAQmxSpectrum estimates the power spectral density of each channel and integrates it over frequency bands.
+    *
+    *
+    * \section intro_sec Description
+    * The NIDAQmxSpectrum implements Welch's method on the block stream:
+    * each channel is cut into Hann-windowed segments of fftSize scans overlapping by half,
+    * the squared magnitude of the FFT of every segment is accumulated, and after the configured number of segments
+    * the averaged one-sided power spectral density is integrated over each band.
+    *
+    * Everything is planned at construction: the twiddle factors, the bit-reversal permutation, the window and all the buffers.
+    * processBlock() only copies samples and runs in-place radix-2 FFTs, so it does not allocate memory.
+    *
+    * The band energies are in squared channel units (e.g. N^2), i.e. the variance of the signal within the band.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxSpectrum.h.
+    */
+    class NIDAQmxSpectrum : public NIDAQmxStage {
+        private:
+            /* ************************************************************ */
+            /* ******* Configuration                                ******* */
+            /**
+             * The number of channels per scan.
+             */
+            size_t nChannels;
+
+            /**
+             * The FFT length, a power of two.
+             */
+            size_t fftSize;
+
+            /**
+             * The number of scans between two segments.
+             */
+            size_t hopSize;
+
+            /**
+             * The number of segments averaged for each estimate.
+             */
+            size_t nAverages;
+
+            /**
+             * The sampling rate in Hz.
+             */
+            double samplingRate;
+
+            /**
+             * The first and one-past-last FFT bin of each band.
+             */
+            std::vector<size_t> bandBins;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* FFT plan                                     ******* */
+            /**
+             * The Hann window.
+             */
+            std::vector<double> window;
+
+            /**
+             * The scale turning the accumulated squared magnitudes into a one-sided density.
+             */
+            double psdScale;
+
+            /**
+             * The cosine and sine twiddle factors.
+             */
+            std::vector<double> twiddleRe;
+            std::vector<double> twiddleIm;
+
+            /**
+             * The bit-reversal permutation.
+             */
+            std::vector<size_t> bitReversed;
+
+            /**
+             * The FFT work buffers.
+             */
+            std::vector<double> workRe;
+            std::vector<double> workIm;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* Streaming state                              ******* */
+            /**
+             * The pending samples of each channel, channel after channel.
+             */
+            std::vector<double> history;
+
+            /**
+             * The number of pending samples per channel.
+             */
+            size_t historyFill;
+
+            /**
+             * The accumulated squared magnitudes of each channel, fftSize/2 + 1 bins per channel.
+             */
+            std::vector<double> powerSum;
+
+            /**
+             * The number of segments accumulated.
+             */
+            size_t segments;
+
+            /**
+             * The band energies of the last estimate, all bands of a channel after the other.
+             */
+            std::vector<double> bandEnergies;
+
+            /**
+             * Whether an estimate is waiting to be collected.
+             */
+            bool ready;
+            /* ************************************************************ */
+
+        public:
+            /**
+             * Default constructor.
+             * \param aNChannels The number of channels per scan
+             * \param aFFTSize The FFT length, rounded up to a power of two
+             * \param aNAverages The number of segments averaged for each estimate
+             * \param aSamplingRate The sampling rate in Hz
+             * \param aBands The lower and upper frequency of each band in Hz, one pair after the other
+             */
+            NIDAQmxSpectrum(const size_t &aNChannels, const size_t &aFFTSize, const size_t &aNAverages, const double &aSamplingRate,
+                    const std::vector<double> &aBands);
+
+            /**
+             * Process a block of sensor values.
+             * \param i_values The sensor values, interleaved by scan
+             */
+            virtual void processBlock(const std::vector<double> &i_values);
+
+            /**
+             * Discard the values accumulated so far.
+             */
+            virtual void reset(void);
+
+            /**
+             * Collect the band energies of the last estimate.
+             * \param o_bandEnergies The band energies, all bands of a channel after the other
+             * \returns true if an estimate was completed since the last call
+             */
+            bool popBandEnergies(std::vector<double> &o_bandEnergies);
+
+        private:
+            /**
+             * Window a segment of one channel and accumulate its squared FFT magnitudes.
+             * \param i_channel The channel
+             */
+            void accumulateSegment(const size_t &i_channel);
+
+            /**
+             * In-place radix-2 FFT of the work buffers.
+             */
+            void transform(void);
+    };
+}
+
+#endif
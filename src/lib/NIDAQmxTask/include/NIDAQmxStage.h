@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXSTAGE_H__
+#define __NIDAQMXSTAGE_H__
+
+#include <vector>
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxStage
+    *
+    * \brief The NIDAQmxStage is the interface of the processing stages fed with the blocks produced by the NIDAQmxTask.
+    *
+    *
+    * \section intro_sec Description
+    * A stage receives every block of calibrated sensor values computed by NIDAQmxTask::runDAQTask(), in acquisition order.
+    * The values are interleaved by scan, one value per channel for each scan, as in NIDAQmxResults::realValues.
+    *
+    * Stages are called on the acquisition thread, or on a NIDAQmxStrand of the shared worker pool, one block at a time,
+    * so processBlock() must not block and should not allocate memory in the steady state.
+    * A stage whose results nobody collects may be skipped, in which case it is reset() before being fed again,
+    * so that no result spans the skipped blocks.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxStage.h.
+    */
+    class NIDAQmxStage {
+        public:
+            /**
+             * Default destructor.
+             */
+            virtual ~NIDAQmxStage(void) { }
+
+            /**
+             * Process a block of sensor values.
+             * \param i_values The sensor values, interleaved by scan
+             */
+            virtual void processBlock(const std::vector<double> &i_values) = 0;
+
+            /**
+             * Discard the values accumulated so far, e.g. after some blocks were not processed.
+             * The next block processed is treated as the first one.
+             */
+            virtual void reset(void) = 0;
+    };
+}
+
+#endif
@@ -26,14 +26,20 @@
 #ifndef __NIDAQMXTASK_H__
 #define __NIDAQMXTASK_H__
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <vector>
 
+#include "NIDAQmxChannelFactory.h"
 #include "NIDAQmxConstants.h"
+#include "NIDAQmxLog.h"
 #include "NIDAQmxTaskConfig.h"
 #include "NIDAQmxSamplingConfig.h"
 #include "NIDAQmxCalibrationConfig.h"
+#include "NIDAQmxCounterConfig.h"
+#include "NIDAQmxTriggerConfig.h"
+#include "NIDAQmxSimulator.h"
 
 /**
  * Common namespace for all NIDAQmx-related constants, structs, typedefs and classes.
@@ -41,7 +47,7 @@
 namespace nidaqmx {
     /**
      * Parameters object for the NIDAQmxTask.
-     * This object groups the parameters contained in the NIDAQmxTaskConfig, NIDAQmxSamplingConfig and NIDAQmxCalibrationConfig objects.
+     * This object groups the parameters contained in the NIDAQmxTaskConfig, NIDAQmxSamplingConfig, NIDAQmxCalibrationConfig and NIDAQmxCounterConfig objects.
      */
     struct NIDAQmxTaskParams {
         /* ******* DAQ task attributes                           ******* */
@@ -50,6 +56,11 @@ namespace nidaqmx {
          */
         std::string DAQDeviceName;
 
+        /**
+         * Whether the task acquires from a simulated device instead of the driver.
+         */
+        bool DAQSimulated;
+
         /**
          * The DAQ task name.
          */
@@ -101,6 +112,36 @@ namespace nidaqmx {
          */
         int DAQSamplingBufferSize;
 
+        /**
+         * The DAQ trigger type: None (continuous acquisition), AnalogEdge or DigitalEdge.
+         */
+        std::string DAQTriggerType;
+
+        /**
+         * The DAQ trigger source, relative to the device (e.g. ai0, PFI0).
+         */
+        std::string DAQTriggerSource;
+
+        /**
+         * The DAQ trigger slope or edge: Rising or Falling.
+         */
+        std::string DAQTriggerSlope;
+
+        /**
+         * The DAQ analog trigger level.
+         */
+        double DAQTriggerLevel;
+
+        /**
+         * The number of samples per channel acquired before the trigger.
+         */
+        int DAQPreTriggerSamples;
+
+        /**
+         * The number of samples per channel acquired from the trigger onwards.
+         */
+        int DAQPostTriggerSamples;
+
         /* ****** DAQ sensor calibration data                   ****** */
         /**
          * The DAQ sensor calibration scales.
@@ -109,9 +150,35 @@ namespace nidaqmx {
         std::vector<double> DAQSensorCalibScales;
 
         /**
-         * The DAQ sensor calibration matrix.
+         * The DAQ sensor calibration matrix, one row per computed sensor value and one column per channel.
          */
         nidaqmx::DoubleMatrix2D DAQSensorCalibMatrix;
+
+        /**
+         * The bias subtracted from the scaled sensor values (empty for none).
+         */
+        std::vector<double> DAQSensorBias;
+
+        /**
+         * The transform applied to the unbiased sensor values, e.g. to a tool frame (empty for the identity).
+         */
+        nidaqmx::DoubleMatrix2D DAQOutputTransform;
+
+        /* ****** DAQ counter attributes                        ****** */
+        /**
+         * The DAQ counters to acquire alongside the analog channels (may be empty).
+         */
+        std::vector<std::string> DAQCounterChannels;
+
+        /**
+         * The DAQ counter channel types.
+         */
+        std::vector<std::string> DAQCounterChannelTypes;
+
+        /**
+         * The DAQ counter scales (pulses per revolution, distance per pulse, etc.).
+         */
+        std::vector<double> DAQCounterScales;
     };
 
     /**
@@ -125,9 +192,92 @@ namespace nidaqmx {
         std::vector<double> analogValues;
 
         /**
-         * The computed sensor values (Newtons, etc.)
+         * The computed sensor values (Newtons, etc.), one value per calibration matrix row for each scan of the analog values.
          */
         std::vector<double> realValues;
+
+        /**
+         * The counter values (degrees, meters, ticks), one value per counter for each scan of the analog values.
+         */
+        std::vector<double> counterValues;
+
+        /**
+         * The number of analog values of each channel at or beyond the configured minimum or maximum value.
+         */
+        std::vector<unsigned int> saturationCounts;
+
+        /**
+         * The channels at or beyond their limits for each scan, as a bit mask (bit i for channel i, the first 32 channels only).
+         */
+        std::vector<unsigned int> saturationFlags;
+
+        /**
+         * The number of scans with at least one channel at or beyond its limits.
+         */
+        unsigned int saturatedScans;
+
+
+        /* ******* Scan index.                                  ******* */
+        /**
+         * The index of the first scan of the block, counted since the task was created.
+         * Consecutive blocks are contiguous unless discontinuity is set.
+         */
+        uInt64 firstScan;
+
+        /**
+         * The NIDAQmxDiscontinuity flags describing why scans are missing before this block, 0 if none are.
+         */
+        unsigned int discontinuity;
+    };
+
+    /**
+     * The reasons why scans may be missing before a block, combined as bit flags in NIDAQmxResults::discontinuity.
+     */
+    enum NIDAQmxDiscontinuity {
+        DiscontinuityOverrun = 1,       // Samples were overwritten in the input buffer before being read
+        DiscontinuityRecovery = 2,      // The task was recreated after a driver error
+        DiscontinuityRestart = 4        // The task was restarted, with new sampling parameters or to re-arm its trigger
+    };
+
+    /**
+     * Durations of the DAQ task initialisation phases, in seconds.
+     */
+    struct NIDAQmxInitTimes {
+        /**
+         * Time spent creating the task handle.
+         */
+        double createTask;
+
+        /**
+         * Time spent creating the channels.
+         */
+        double createChannels;
+
+        /**
+         * Time spent configuring the sample clock and input buffer.
+         */
+        double configureTiming;
+
+        /**
+         * Time spent starting the task.
+         */
+        double startTask;
+
+        /**
+         * Time spent waiting for the first samples in waitDAQTaskReady().
+         */
+        double waitReady;
+    };
+
+    /**
+     * The classes of driver errors, according to what the acquisition needs to recover from them.
+     */
+    enum NIDAQmxErrorClass {
+        ErrorNone,          // No driver error
+        ErrorTransient,     // The samples were not ready in time, the next read may succeed
+        ErrorOverrun,       // Samples were overwritten in the input buffer, the task must be restarted
+        ErrorDeviceLost,    // The device is no longer accessible, the task must be recreated
+        ErrorOther          // Any other error, handled as a lost device
     };
 
     /**
@@ -163,6 +313,13 @@ namespace nidaqmx {
     *
     * It is important to clear any task which is created using this API to free any allocated memory.
     *
+    * Every block carries the index of its first scan, counted since the task was created, so that lost scans can be told
+    * from a quiet sensor by comparing indices. Blocks following a restart or a recovery are flagged as discontinuous;
+    * after a recovery the index also skips the scans estimated to have been acquired while the task was down.
+    *
+    * When a method fails because of a driver error, classifyLastError() tells whether the failure is transient,
+    * or whether the task must be restarted with recoverDAQTask(), which clears and recreates it within a time budget.
+    *
     * The NIDAQmxTask is configured to perform continuous data acquisition.
     * NIDAQmx continuous data acquisition tasks work by sampling data at a given frequency.
     * The samples are then placed into a circular buffer.
@@ -173,6 +330,31 @@ namespace nidaqmx {
     *
     * These parameters (sampling rate, number of samples to read from the buffer, etc.) are set by the user and passed to the task constructor.
     *
+    * With DAQSimulated set, the driver is never called and the samples come from a NIDAQmxSimulator acquiring at the same rate,
+    * which makes it possible to run and measure the whole acquisition on a machine without the device.
+    *
+    * Counter channels (encoders, edge counters) can be acquired alongside the analog channels.
+    * NIDAQmx does not allow counters in an analog input task, so each counter runs in its own task clocked by the analog input sample clock.
+    * The counter tasks are started before the analog task, so that every counter sample is latched on the same clock edge as the matching analog scan,
+    * and runDAQTask() reads as many counter samples as analog scans.
+    *
+    * Alternatively the task can be configured for triggered acquisition with a NIDAQmxTriggerConfig.
+    * The device then acquires a finite window of pre-trigger and post-trigger samples around an analog or digital reference trigger,
+    * at a rate limited only by the device since no host read is needed until the window is complete.
+    * runDAQTask() returns an empty block until the window has been captured, then returns the whole window as one block and re-arms the trigger.
+    * Counters are not supported in triggered mode.
+    *
+    * Every analog block is checked against the minimum and maximum values configured for each channel,
+    * which are the limits of the range requested from the device.
+    * Values at or beyond these limits are counted per channel and flagged per scan in the NIDAQmxResults.
+    *
+    * Both the calibration and the sampling configuration can be changed while the task is running:
+    *     - setCalibrationConfig() writes the new calibration into a spare buffer which the reading thread swaps in at the start of the next block.
+    *       The swap is lock-free, so the reading thread never waits on the caller.
+    *       When the calibration is deferred with setCalibrationDeferred(), the thread calling calibrateResults() does the swap with applyPendingCalibration(),
+    *       once per block whether or not the block is calibrated.
+    *     - setSamplingConfig() stops the task, applies the new timing and buffer size and restarts it without recreating the task or its channels.
+    *
     *
     * \section lib_sec Libraries
     * This wrapper depends on different libraries depending on the operative system:
@@ -225,24 +407,143 @@ namespace nidaqmx {
             nidaqmx::NIDAQmxSamplingConfig DAQSamplingConfig;
 
             /**
-             * The sensor calibration configuration object.
+             * The DAQ trigger configuration object.
+             */
+            nidaqmx::NIDAQmxTriggerConfig DAQTriggerConfig;
+
+            /**
+             * The double-buffered sensor calibration configuration objects.
+             * The reading thread only uses the entry at DAQCalibrationIndex, while setCalibrationConfig() only writes to the other one.
+             */
+            std::vector<nidaqmx::NIDAQmxCalibrationConfig> DAQCalibrationConfigs;
+
+            /**
+             * The index of the calibration configuration currently in use by the reading thread.
+             * This is only ever modified by the reading thread.
+             */
+            std::atomic<int> DAQCalibrationIndex;
+
+            /**
+             * Whether the spare calibration configuration holds a new calibration waiting to be swapped in.
+             */
+            std::atomic<bool> DAQCalibrationPending;
+
+            /**
+             * Whether the calibration is left to calibrateResults() instead of being computed by runDAQTask().
+             */
+            bool DAQCalibrationDeferred;
+
+            /**
+             * The durations of the last initialisation phases.
+             */
+            nidaqmx::NIDAQmxInitTimes DAQInitTimes;
+
+            /**
+             * The code of the last driver error, 0 if the last run succeeded.
+             */
+            int DAQLastError;
+
+            /**
+             * The index of the next scan to be read.
+             */
+            uInt64 DAQScanIndex;
+
+            /**
+             * The NIDAQmxDiscontinuity flags to report with the next block read.
+             */
+            unsigned int DAQPendingDiscontinuity;
+
+            /**
+             * The time of the last successful read.
+             */
+            double DAQLastReadTime;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* DAQ counter attributes                       ******* */
+            /**
+             * The DAQ counter configuration object.
+             */
+            nidaqmx::NIDAQmxCounterConfig DAQCounterConfig;
+
+            /**
+             * The counter task handles, one per counter channel.
+             */
+            std::vector<TaskHandle> DAQCounterTaskHandles;
+
+            /**
+             * The buffer into which a single counter is read.
+             */
+            std::vector<double> counterBuffer;
+
+            /**
+             * The buffer into which the analog samples are read, sized on the first read and reused afterwards.
+             */
+            std::vector<double> analogBuffer;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* Simulation                                   ******* */
+            /**
+             * Whether the driver calls are replaced by the simulated device.
+             */
+            bool DAQSimulated;
+
+            /**
+             * The simulated device.
+             */
+            nidaqmx::NIDAQmxSimulator DAQSimulator;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* Saturation detection                         ******* */
+            /**
+             * The channel minimum values, repeated for as many scans as the largest block read.
+             */
+            std::vector<double> saturationMin;
+
+            /**
+             * The channel maximum values, repeated for as many scans as the largest block read.
              */
-            nidaqmx::NIDAQmxCalibrationConfig DAQCalibrationConfig;
+            std::vector<double> saturationMax;
             /* ************************************************************ */
 
 
             /* ************************************************************ */
             /* ******* Conversion maps.                             ******* */
             /**
-             * The DAQ Channel type map.
-             * Maps the string input parameters to the corresponding NIDAQmx integer constants.
+             * The DAQ Channel factory.
+             * Maps the channel type names to the NIDAQmx functions creating them.
              */
-            std::map<std::string, int> channelTypes;
+            nidaqmx::NIDAQmxChannelFactory channelFactory;
             /**
              * The DAQ Terminal configuration map.
              * Maps the string input parameters to the corresponding NIDAQmx integer constants.
              */
             std::map<std::string, int> terminalConfigs;
+
+            /**
+             * The DAQ Trigger slope map.
+             * Maps the string input parameters to the corresponding NIDAQmx integer constants.
+             */
+            std::map<std::string, int> triggerSlopes;
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* Logging.                                     ******* */
+            /**
+             * Rate limiter for the per-read debug message.
+             */
+            nidaqmx::NIDAQmxLogLimiter readLogLimiter;
+
+            /**
+             * Rate limiter for the saturation warning.
+             */
+            nidaqmx::NIDAQmxLogLimiter saturationLogLimiter;
             /* ************************************************************ */
 
         public:
@@ -266,12 +567,60 @@ namespace nidaqmx {
              */
             bool initialiseDAQTask(void);
 
+            /**
+             * Initialise several DAQ tasks concurrently, one thread per task.
+             * This is meant for processes driving more than one device, whose initialisations are otherwise serialised.
+             * \param i_tasks The tasks to initialise
+             * \returns true if all tasks were initialised
+             */
+            static bool initialiseDAQTasks(std::vector<NIDAQmxTask *> &i_tasks);
+
+            /**
+             * Wait until the started DAQ task has acquired its first samples.
+             * \param i_timeout The maximum time to wait in seconds
+             */
+            bool waitDAQTaskReady(const double &i_timeout);
+
+            /**
+             * Get the durations of the initialisation phases.
+             * \returns The durations of the last initialisation phases
+             */
+            const nidaqmx::NIDAQmxInitTimes &getInitTimes(void) const;
+
             /**
              * Run the DAQ task and read the data samples in the given array.
              * \param i_results The result structure in which to store the sensor values
              */
             bool runDAQTask(nidaqmx::NIDAQmxResults &i_results);
 
+            /**
+             * Leave the calibration of the blocks read by runDAQTask() to calibrateResults(),
+             * so that it can be run on another thread, e.g. by a NIDAQmxStrand, while the reading thread reads the next block.
+             * \param i_deferred Whether runDAQTask() leaves the real values empty
+             */
+            void setCalibrationDeferred(const bool &i_deferred);
+
+            /**
+             * Compute the real values of a block read by runDAQTask() while the calibration is deferred.
+             * The blocks must be calibrated in the order they were read and by one thread at a time.
+             * \param io_results The block read, whose real values are computed
+             */
+            bool calibrateResults(nidaqmx::NIDAQmxResults &io_results);
+
+            /**
+             * Swap in the calibration set by setCalibrationConfig(), if any.
+             * runDAQTask() does so before calibrating each block; while the calibration is deferred
+             * it must instead be called once per block by the thread calling calibrateResults(), even for the blocks it does not calibrate.
+             * \returns Whether a new calibration was swapped in
+             */
+            bool applyPendingCalibration(void);
+
+            /**
+             * Get the index of the next scan to be read, i.e. the first scan of the next block.
+             * \returns The scan index
+             */
+            uInt64 getScanIndex(void) const;
+
             /**
              * Stop the DAQ task.
              */
@@ -283,6 +632,63 @@ namespace nidaqmx {
             bool clearDAQTask(void);
             /* ************************************************************ */
 
+
+            /* ************************************************************ */
+            /* ******* Error recovery.                              ******* */
+            /**
+             * Get the code of the last driver error.
+             * \returns The NIDAQmx error code, 0 if no error occurred since the last successful runDAQTask()
+             */
+            int getLastError(void) const;
+
+            /**
+             * Classify the last driver error.
+             * \returns The class of the last error
+             */
+            nidaqmx::NIDAQmxErrorClass classifyLastError(void) const;
+
+            /**
+             * Classify a driver error code.
+             * \param i_errorCode The NIDAQmx error code
+             * \returns The class of the error
+             */
+            static nidaqmx::NIDAQmxErrorClass classifyError(const int &i_errorCode);
+
+            /**
+             * Restart a failed DAQ task: stop and clear it, then recreate and start it until it acquires samples again.
+             * The configuration, including the current calibration and sampling, is kept.
+             * This method must be called from the thread calling runDAQTask().
+             * \param i_budget The maximum time to spend recovering in seconds
+             * \returns true if the task is acquiring again
+             */
+            bool recoverDAQTask(const double &i_budget);
+            /* ************************************************************ */
+
+
+            /* ************************************************************ */
+            /* ******* Live reconfiguration.                        ******* */
+            /**
+             * Replace the sensor calibration used by the running task.
+             * The new calibration is taken into account from the next block read by runDAQTask().
+             * This method may be called from any thread but fails if a previously set calibration has not been swapped in yet.
+             * The new calibration must compute as many outputs as the current one.
+             * \param aDAQSensorCalibScales The new sensor calibration scales
+             * \param aDAQSensorCalibMatrix The new sensor calibration matrix
+             * \param aDAQSensorBias The new bias subtracted from the scaled values (empty for none)
+             * \param aDAQOutputTransform The new output transform (empty for the identity)
+             */
+            bool setCalibrationConfig(const std::vector<double> &aDAQSensorCalibScales, const DoubleMatrix2D &aDAQSensorCalibMatrix,
+                    const std::vector<double> &aDAQSensorBias = std::vector<double>(), const DoubleMatrix2D &aDAQOutputTransform = DoubleMatrix2D());
+
+            /**
+             * Restart the running task with new sampling parameters, keeping the task and its channels.
+             * If the new configuration is rejected the previous one is restored and the task restarted with it.
+             * This method must be called from the thread calling runDAQTask().
+             * \param aDAQSamplingConfig The new sampling configuration
+             */
+            bool setSamplingConfig(const nidaqmx::NIDAQmxSamplingConfig &aDAQSamplingConfig);
+            /* ************************************************************ */
+
         private:
             /* ************************************************************ */
             /* ******* Task handling steps.                         ******* */
@@ -296,17 +702,49 @@ namespace nidaqmx {
              */
             bool createDAQChannels(void);
 
+            /**
+             * Create one task per counter channel and add the counter channel to it.
+             */
+            bool createDAQCounterTasks(void);
+
+            /**
+             * Configure the DAQ sampling clock and input buffer of the analog and counter tasks.
+             */
+            bool configureDAQTiming(void);
+
+            /**
+             * Configure the reference trigger of a triggered DAQ task.
+             */
+            bool configureDAQTrigger(void);
+
+            /**
+             * Restart a triggered DAQ task after its window was read, so that it waits for the next trigger.
+             */
+            bool rearmDAQTask(void);
+
             /**
              * Start the DAQ task.
              */
             bool startDAQTask(void);
 
+            /**
+             * Stop and clear the DAQ task ignoring errors, so that it can be recreated after a driver failure.
+             */
+            void releaseDAQTask(void);
+
             /**
              * Reads the samples from the sensor into the input vector.
              * \param i_analog The vector in which the sensor values will be read
              */
             bool readAnalogValues(std::vector<double> &i_analog);
 
+            /**
+             * Reads the counter samples matching the last analog scans.
+             * \param i_nScans The number of analog scans read
+             * \param o_counter The vector in which the counter values will be read, interleaved by scan
+             */
+            bool readCounterValues(const int &i_nScans, std::vector<double> &o_counter);
+
             /**
              * Converts the input voltage values into intelligible sensor values (force, torque, etc.).
              * \param i_analog The input voltage values to be converted
@@ -314,6 +752,13 @@ namespace nidaqmx {
              */
             bool computeSensorValues(std::vector<double> &i_analog, std::vector<double> &o_real);
 
+            /**
+             * Flags the analog values at or beyond the configured channel limits.
+             * \param i_analog The analog values
+             * \param o_results The result structure in which to store the saturation counts and flags
+             */
+            void detectSaturation(const std::vector<double> &i_analog, nidaqmx::NIDAQmxResults &o_results);
+
             /**
              * Error handling done sensibly.
              * This method is called to check the error codes returned by NIDAQmx C api functions.
@@ -331,14 +776,14 @@ namespace nidaqmx {
             void generateMaps(void);
 
             /**
-             * Generate the mapping of NIDAQmx C API channel types to C++ DAQChannelType enum.
+             * Generate the mapping of NIDAQmx C API terminal configurations to C++ DAQTerminalConfig enum.
              */
-            void generateChannelTypesMap(void);
+            void generateTerminalConfigsMap(void);
 
             /**
-             * Generate the mapping of NIDAQmx C API terminal configurations to C++ DAQTerminalConfig enum.
+             * Generate the mapping of NIDAQmx C API trigger slopes to C++ DAQTriggerSlope enum.
              */
-            void generateTerminalConfigsMap(void);
+            void generateTriggerSlopesMap(void);
             /* ************************************************************ */
     };
 }
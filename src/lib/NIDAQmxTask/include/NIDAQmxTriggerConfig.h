@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXTRIGGERCONFIG_H__
+#define __NIDAQMXTRIGGERCONFIG_H__
+
+#include <string>
+
+namespace nidaqmx {
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxTriggerConfig
+    *
+    * \brief The NIDAQmxTriggerConfig is the configuration object for the triggered acquisition mode.
+    *
+    *
+    * \section intro_sec Description
+    * The NIDAQmxTriggerConfig is the configuration object for the reference trigger of the DAQ task.
+    * With a trigger type other than None the task acquires a finite window around the trigger instead of sampling continuously:
+    * the device keeps the pre-trigger samples in its own buffer and stops after the post-trigger samples.
+    * The trigger types are:
+    *     - None: continuous acquisition (default)
+    *     - AnalogEdge: the trigger source is an analog input channel (e.g. ai0) crossing the trigger level on the trigger slope
+    *     - DigitalEdge: the trigger source is a digital terminal (e.g. PFI0) and the trigger slope is its active edge
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxTriggerConfig.h.
+    */
+    class NIDAQmxTriggerConfig {
+        private:
+            /* ************************************************************ */
+            /* ******* DAQ trigger attributes                       ******* */
+            /**
+             * The trigger type: None, AnalogEdge or DigitalEdge.
+             */
+            std::string DAQTriggerType;
+
+            /**
+             * The trigger source, relative to the device.
+             */
+            std::string DAQTriggerSource;
+
+            /**
+             * The trigger slope or edge: Rising or Falling.
+             */
+            std::string DAQTriggerSlope;
+
+            /**
+             * The analog trigger level, in the units of the source channel.
+             */
+            double DAQTriggerLevel;
+
+            /**
+             * The number of samples per channel acquired before the trigger.
+             */
+            int DAQPreTriggerSamples;
+
+            /**
+             * The number of samples per channel acquired from the trigger onwards.
+             */
+            int DAQPostTriggerSamples;
+            /* ************************************************************ */
+
+        public:
+            /**
+             * Default constructor.
+             * \param aDAQTriggerType The trigger type
+             * \param aDAQTriggerSource The trigger source
+             * \param aDAQTriggerSlope The trigger slope or edge
+             * \param aDAQTriggerLevel The analog trigger level
+             * \param aDAQPreTriggerSamples The number of samples per channel acquired before the trigger
+             * \param aDAQPostTriggerSamples The number of samples per channel acquired from the trigger onwards
+             */
+            NIDAQmxTriggerConfig(const std::string &aDAQTriggerType, const std::string &aDAQTriggerSource, const std::string &aDAQTriggerSlope,
+                    const double &aDAQTriggerLevel, const int &aDAQPreTriggerSamples, const int &aDAQPostTriggerSamples);
+
+            /* ************************************************************ */
+            /* ******* Getters.                                     ******* */
+
+            /**
+             * Get the trigger type.
+             * \returns The trigger type.
+             */
+            std::string &getDAQTriggerType();
+
+            /**
+             * Get the trigger source.
+             * \returns The trigger source.
+             */
+            std::string &getDAQTriggerSource();
+
+            /**
+             * Get the trigger slope or edge.
+             * \returns The trigger slope.
+             */
+            std::string &getDAQTriggerSlope();
+
+            /**
+             * Get the analog trigger level.
+             * \returns The trigger level.
+             */
+            double &getDAQTriggerLevel();
+
+            /**
+             * Get the number of pre-trigger samples per channel.
+             * \returns The number of pre-trigger samples.
+             */
+            int &getDAQPreTriggerSamples();
+
+            /**
+             * Get the number of post-trigger samples per channel.
+             * \returns The number of post-trigger samples.
+             */
+            int &getDAQPostTriggerSamples();
+
+            /**
+             * Check whether the task is triggered.
+             * \returns true if the trigger type is not None.
+             */
+            bool isTriggered() const;
+            /* ************************************************************ */
+    };
+}
+
+#endif
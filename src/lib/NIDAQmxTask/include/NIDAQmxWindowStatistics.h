@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+#ifndef __NIDAQMXWINDOWSTATISTICS_H__
+#define __NIDAQMXWINDOWSTATISTICS_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "NIDAQmxStage.h"
+
+namespace nidaqmx {
+    /**
+     * The per-channel statistics of a window of scans.
+     */
+    struct NIDAQmxStatistics {
+        /**
+         * The number of scans in the window.
+         */
+        size_t nScans;
+
+        /**
+         * The minimum value of each channel.
+         */
+        std::vector<double> min;
+
+        /**
+         * The maximum value of each channel.
+         */
+        std::vector<double> max;
+
+        /**
+         * The mean value of each channel.
+         */
+        std::vector<double> mean;
+
+        /**
+         * The root mean square of each channel.
+         */
+        std::vector<double> rms;
+
+        /**
+         * The (population) variance of each channel.
+         */
+        std::vector<double> variance;
+    };
+
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxWindowStatistics
+    *
+    * \brief The NIDAQmxWindowStatistics computes per-channel statistics over consecutive windows of scans.
+    *
+    *
+    * \section intro_sec Description
+    * The NIDAQmxWindowStatistics updates the minimum, maximum, mean and variance of every channel incrementally, one scan at a time,
+    * using Welford's method for the mean and variance so that long windows do not lose precision.
+    * All channels share the scan count, so the update of one scan is a single loop over the channels which the compiler vectorises.
+    * The root mean square is derived from the mean and variance when the window is complete.
+    *
+    * Windows do not overlap: a complete window is handed over with popStatistics() and the next one starts from the following scan.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxWindowStatistics.h.
+    */
+    class NIDAQmxWindowStatistics : public NIDAQmxStage {
+        private:
+            /**
+             * The number of channels per scan.
+             */
+            size_t nChannels;
+
+            /**
+             * The number of scans per window.
+             */
+            size_t windowScans;
+
+            /**
+             * The number of scans accumulated in the current window.
+             */
+            size_t count;
+
+            /**
+             * The running statistics of the current window.
+             * The variance field holds the running sum of squared deviations until the window is complete.
+             */
+            nidaqmx::NIDAQmxStatistics current;
+
+            /**
+             * The last complete window.
+             */
+            nidaqmx::NIDAQmxStatistics completed;
+
+            /**
+             * Whether a complete window is waiting to be collected.
+             */
+            bool ready;
+
+        public:
+            /**
+             * Default constructor.
+             * \param aNChannels The number of channels per scan
+             * \param aWindowScans The number of scans per window
+             */
+            NIDAQmxWindowStatistics(const size_t &aNChannels, const size_t &aWindowScans);
+
+            /**
+             * Process a block of sensor values.
+             * \param i_values The sensor values, interleaved by scan
+             */
+            virtual void processBlock(const std::vector<double> &i_values);
+
+            /**
+             * Discard the values accumulated so far.
+             */
+            virtual void reset(void);
+
+            /**
+             * Collect the statistics of the last complete window.
+             * \param o_statistics The window statistics
+             * \returns true if a window was complete since the last call
+             */
+            bool popStatistics(nidaqmx::NIDAQmxStatistics &o_statistics);
+
+        private:
+            /**
+             * Start a new window.
+             */
+            void resetWindow(void);
+    };
+}
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+
+
+#ifndef __NIDAQMXWORKERPOOL_H__
+#define __NIDAQMXWORKERPOOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nidaqmx {
+    /**
+     * A unit of work run by the NIDAQmxWorkerPool.
+     */
+    class NIDAQmxJob {
+        public:
+            /**
+             * Default destructor.
+             */
+            virtual ~NIDAQmxJob(void) { }
+
+            /**
+             * Run the job on a worker thread.
+             */
+            virtual void run(void) = 0;
+
+            /**
+             * Dispose of the job once a NIDAQmxStrand has run it.
+             * The job is deleted unless overridden, e.g. by a job returning itself to a preallocated set.
+             */
+            virtual void release(void) { delete this; }
+    };
+
+
+    /**
+    * \cond
+    * @ingroup icub_NIDAQmxTask
+    * \endcond
+    * \class NIDAQmxWorkerPool
+    *
+    * \brief The NIDAQmxWorkerPool runs the processing of the acquired blocks on a pool of threads shared by all the tasks of a process.
+    *
+    *
+    * \section intro_sec Description
+    * The pool starts one worker thread per core on first use.
+    * Each worker has its own queue: it runs the jobs of its queue newest first and, once it is empty,
+    * steals the oldest job from the queue of another worker, so that the load is balanced across cores
+    * whatever the number of acquisition threads submitting jobs.
+    *
+    * The pool does not order the jobs it runs. Jobs which must run in order, such as the blocks of one task,
+    * are posted to a NIDAQmxStrand instead.
+    * The pool never deletes the jobs submitted to it.
+    *
+    *
+    * \author NIDAQmx contributors
+    *
+    * \copyright
+    *
+    * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+    *
+    * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+    *
+    * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/lib/include/NIDAQmxWorkerPool.h.
+    */
+    class NIDAQmxWorkerPool {
+        private:
+            /**
+             * The job queue of a worker.
+             */
+            struct Queue {
+                std::mutex mutex;
+                std::deque<NIDAQmxJob*> jobs;
+            };
+
+            /**
+             * The worker queues.
+             */
+            std::vector<Queue*> queues;
+
+            /**
+             * The worker threads.
+             */
+            std::vector<std::thread> workers;
+
+            /**
+             * The queue receiving the next job submitted.
+             */
+            std::atomic<size_t> nextQueue;
+
+            /**
+             * The number of jobs queued and not yet taken by a worker, counted just before a job is pushed.
+             */
+            std::atomic<size_t> nQueued;
+
+            /**
+             * Whether the workers must exit.
+             */
+            std::atomic<bool> stopping;
+
+            /**
+             * The mutex and condition on which idle workers wait.
+             */
+            std::mutex idleMutex;
+            std::condition_variable idleCondition;
+
+            /**
+             * Default constructor.
+             * \param aNWorkers The number of worker threads
+             */
+            NIDAQmxWorkerPool(const size_t &aNWorkers);
+
+            /**
+             * Take a job from the worker queue, or steal one from another worker.
+             * \param i_worker The worker index
+             * \returns The job, or NULL if all the queues are empty
+             */
+            NIDAQmxJob *takeJob(const size_t &i_worker);
+
+            /**
+             * The worker loop.
+             * \param i_worker The worker index
+             */
+            void run(size_t i_worker);
+
+        public:
+            /**
+             * Default destructor.
+             * Waits for the running jobs and stops the workers, the jobs still queued are not run.
+             */
+            ~NIDAQmxWorkerPool(void);
+
+            /**
+             * Get the process-wide pool, started on first use.
+             */
+            static NIDAQmxWorkerPool &instance(void);
+
+            /**
+             * Get the number of worker threads.
+             */
+            size_t getNWorkers(void) const;
+
+            /**
+             * Queue a job to be run by one of the workers.
+             * \param i_job The job, which must stay valid until it has run
+             */
+            void submit(NIDAQmxJob *i_job);
+    };
+
+
+    /**
+     * A sequence of jobs run one at a time and in the order they were posted, on the threads of the NIDAQmxWorkerPool.
+     * A strand only occupies a worker while it has jobs, so several strands share the pool without holding a thread each.
+     * The jobs posted to a strand are released once they have run, which deletes them unless NIDAQmxJob::release() is overridden.
+     */
+    class NIDAQmxStrand : private NIDAQmxJob {
+        private:
+            /**
+             * The jobs posted and not yet run.
+             */
+            std::deque<NIDAQmxJob*> jobs;
+
+            /**
+             * Whether the strand is submitted to the pool or running.
+             */
+            bool scheduled;
+
+            /**
+             * The mutex protecting the jobs and the scheduled flag.
+             */
+            std::mutex mutex;
+
+            /**
+             * The condition signalled when the strand becomes idle.
+             */
+            std::condition_variable idleCondition;
+
+            /**
+             * Run the posted jobs until none is left.
+             */
+            void run(void);
+
+        public:
+            /**
+             * Default constructor.
+             */
+            NIDAQmxStrand(void);
+
+            /**
+             * Default destructor.
+             * Waits for the posted jobs to have run.
+             */
+            ~NIDAQmxStrand(void);
+
+            /**
+             * Post a job to the strand, taking ownership of it: the job is released once it has run.
+             * \param i_job The job
+             */
+            void post(NIDAQmxJob *i_job);
+
+            /**
+             * Get the number of jobs posted and not yet completed.
+             */
+            size_t getNPending(void);
+
+            /**
+             * Wait for all the jobs posted so far to have run.
+             */
+            void drain(void);
+    };
+}
+
+#endif
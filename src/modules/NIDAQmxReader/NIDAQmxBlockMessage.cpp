@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+
+
+#include "NIDAQmxBlockMessage.h"
+
+#include <cstring>
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default Constructor.                                             ********************************************** */
+NIDAQmxBlockMessage::NIDAQmxBlockMessage() {
+    std::memset(&header, 0, sizeof(header));
+    header.version = version;
+    header.type = BlockFloat64;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the message header.                                          ********************************************** */
+NIDAQmxBlockHeader &NIDAQmxBlockMessage::getHeader(void) {
+    return header;
+}
+
+const NIDAQmxBlockHeader &NIDAQmxBlockMessage::getHeader(void) const {
+    return header;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Set the timing of the block.                                     ********************************************** */
+void NIDAQmxBlockMessage::setTiming(const uint64_t &i_firstScan, const double &i_t0, const double &i_dt, const uint32_t &i_flags) {
+    header.firstScan = i_firstScan;
+    header.t0 = i_t0;
+    header.dt = i_dt;
+    header.flags = i_flags;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Size the block for floating point values.                        ********************************************** */
+double *NIDAQmxBlockMessage::resizeFloat64(const uint32_t &i_nScans, const uint32_t &i_nChannels) {
+    header.type = BlockFloat64;
+    header.nScans = i_nScans;
+    header.nChannels = i_nChannels;
+    header.packedSize = 0;
+
+    // The payload keeps its capacity from block to block
+    payload.resize((size_t) i_nScans * i_nChannels * sizeof(double));
+
+    return payload.empty() ? NULL : reinterpret_cast<double *>(&payload[0]);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Copy floating point values into the block.                       ********************************************** */
+void NIDAQmxBlockMessage::setFloat64(const double *i_values, const uint32_t &i_nScans, const uint32_t &i_nChannels) {
+    double *values = resizeFloat64(i_nScans, i_nChannels);
+    if (values) {
+        std::memcpy(values, i_values, payload.size());
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the floating point values.                                   ********************************************** */
+const double *NIDAQmxBlockMessage::getFloat64(void) const {
+    if ((header.type != BlockFloat64) || payload.empty()) {
+        return NULL;
+    }
+
+    return reinterpret_cast<const double *>(&payload[0]);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Size the block for quantised values.                             ********************************************** */
+int16_t *NIDAQmxBlockMessage::resizeInt16(const uint32_t &i_nScans, const uint32_t &i_nChannels, const double *i_scales, const double *i_offsets) {
+    header.type = BlockInt16;
+    header.nScans = i_nScans;
+    header.nChannels = i_nChannels;
+    header.packedSize = 0;
+
+    size_t parametersSize = 2 * (size_t) i_nChannels * sizeof(double);
+    payload.resize(parametersSize + (size_t) i_nScans * i_nChannels * sizeof(int16_t));
+    if (payload.empty()) {
+        return NULL;
+    }
+
+    std::memcpy(&payload[0], i_scales, i_nChannels * sizeof(double));
+    std::memcpy(&payload[i_nChannels * sizeof(double)], i_offsets, i_nChannels * sizeof(double));
+
+    return reinterpret_cast<int16_t *>(&payload[parametersSize]);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the quantised values.                                        ********************************************** */
+const int16_t *NIDAQmxBlockMessage::getInt16(void) const {
+    if ((header.type != BlockInt16) || payload.empty()) {
+        return NULL;
+    }
+
+    return reinterpret_cast<const int16_t *>(&payload[2 * (size_t) header.nChannels * sizeof(double)]);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Pack quantised values into the block.                            ********************************************** */
+void NIDAQmxBlockMessage::packInt16(const int16_t *i_values, const uint32_t &i_nScans, const uint32_t &i_nChannels,
+        const double *i_scales, const double *i_offsets) {
+    header.type = BlockInt16Delta;
+    header.nScans = i_nScans;
+    header.nChannels = i_nChannels;
+
+    size_t parametersSize = 2 * (size_t) i_nChannels * sizeof(double);
+    payload.resize(parametersSize + nidaqmx::NIDAQmxDeltaCodec::maxEncodedSize(i_nScans, i_nChannels));
+    if (payload.empty()) {
+        header.packedSize = 0;
+        return;
+    }
+
+    std::memcpy(&payload[0], i_scales, i_nChannels * sizeof(double));
+    std::memcpy(&payload[i_nChannels * sizeof(double)], i_offsets, i_nChannels * sizeof(double));
+
+    // Encoded in place, then trimmed to the size actually used
+    unsigned char *packed = reinterpret_cast<unsigned char *>(&payload[parametersSize]);
+    header.packedSize = (uint32_t) nidaqmx::NIDAQmxDeltaCodec::encode(i_values, i_nScans, i_nChannels, packed);
+    payload.resize(parametersSize + header.packedSize);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get a copy of the quantised values.                              ********************************************** */
+bool NIDAQmxBlockMessage::unpackInt16(std::vector<int16_t> &o_values) const {
+    size_t nValues = (size_t) header.nScans * header.nChannels;
+    size_t parametersSize = 2 * (size_t) header.nChannels * sizeof(double);
+
+    o_values.resize(nValues);
+    if (nValues == 0) {
+        return (header.type == BlockInt16) || (header.type == BlockInt16Delta);
+    }
+
+    if (header.type == BlockInt16) {
+        std::memcpy(&o_values[0], &payload[parametersSize], nValues * sizeof(int16_t));
+        return true;
+    } else if (header.type == BlockInt16Delta) {
+        const unsigned char *packed = reinterpret_cast<const unsigned char *>(&payload[parametersSize]);
+        return nidaqmx::NIDAQmxDeltaCodec::decode(packed, header.packedSize, header.nScans, header.nChannels, &o_values[0]);
+    }
+
+    return false;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the quantisation scales.                                     ********************************************** */
+const double *NIDAQmxBlockMessage::getInt16Scales(void) const {
+    if (((header.type != BlockInt16) && (header.type != BlockInt16Delta)) || payload.empty()) {
+        return NULL;
+    }
+
+    return reinterpret_cast<const double *>(&payload[0]);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the quantisation offsets.                                    ********************************************** */
+const double *NIDAQmxBlockMessage::getInt16Offsets(void) const {
+    if (((header.type != BlockInt16) && (header.type != BlockInt16Delta)) || payload.empty()) {
+        return NULL;
+    }
+
+    return reinterpret_cast<const double *>(&payload[header.nChannels * sizeof(double)]);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the size of the message.                                     ********************************************** */
+size_t NIDAQmxBlockMessage::getSize(void) const {
+    return sizeof(header) + payload.size();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Write the message.                                               ********************************************** */
+bool NIDAQmxBlockMessage::write(yarp::os::ConnectionWriter &connection) {
+    // The payload is referenced rather than copied, the port keeps the message until it is sent
+    connection.appendBlock(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!payload.empty()) {
+        connection.appendExternalBlock(&payload[0], payload.size());
+    }
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Read the message.                                                ********************************************** */
+bool NIDAQmxBlockMessage::read(yarp::os::ConnectionReader &connection) {
+    // Everything is bounded by what the connection holds, so that a corrupted header cannot make the payload grow without limit
+    size_t messageSize = connection.getSize();
+    if ((messageSize < sizeof(header))
+            || !connection.expectBlock(reinterpret_cast<const char *>(&header), sizeof(header)) || (header.version != version)) {
+        return false;
+    }
+    size_t available = messageSize - sizeof(header);
+
+    size_t valueSize = 0;
+    size_t parametersSize = 0;
+    switch (header.type) {
+        case BlockFloat64:
+            valueSize = sizeof(double);
+            break;
+        case BlockInt16:
+            valueSize = sizeof(int16_t);
+            if (header.nChannels > available / (2 * sizeof(double))) {
+                return false;
+            }
+            parametersSize = 2 * (size_t) header.nChannels * sizeof(double);
+            break;
+        case BlockInt16Delta:
+            if ((header.nChannels > available / (2 * sizeof(double)))
+                    || (header.packedSize > available - 2 * (size_t) header.nChannels * sizeof(double))
+                    || (header.packedSize > nidaqmx::NIDAQmxDeltaCodec::maxEncodedSize(header.nScans, header.nChannels))) {
+                return false;
+            }
+            parametersSize = 2 * (size_t) header.nChannels * sizeof(double) + header.packedSize;
+            break;
+        default:
+            return false;
+    }
+
+    // Divided rather than multiplied, so that the bound cannot overflow
+    size_t valuesSize = 0;
+    if ((valueSize > 0) && (header.nChannels > 0)) {
+        if (header.nScans > (available - parametersSize) / valueSize / header.nChannels) {
+            return false;
+        }
+        valuesSize = (size_t) header.nScans * header.nChannels * valueSize;
+    }
+
+    // Read straight into the payload, the values are then used in place
+    payload.resize(parametersSize + valuesSize);
+    if (payload.empty()) {
+        return true;
+    }
+
+    return connection.expectBlock(&payload[0], payload.size());
+}
+/* *********************************************************************************************************************** */
@@ -0,0 +1,466 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+
+
+
+#include "NIDAQmxMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#elif _WIN32
+#include <winsock2.h>
+#endif
+
+#include <NIDAQmxTask/include/NIDAQmxFunctions.h>
+
+using nidaqmx::monotonicNanoseconds;
+using std::pair;
+using std::string;
+using std::vector;
+
+
+namespace {
+#ifdef __linux__
+    const NIDAQmxSocket invalidSocket = -1;
+    const int sendFlags = MSG_NOSIGNAL;     // A scraper leaving early must not kill the module
+
+    void closeSocket(NIDAQmxSocket i_socket) {
+        ::close(i_socket);
+    }
+
+    void setSocketTimeouts(NIDAQmxSocket i_socket, int i_milliseconds) {
+        timeval timeout;
+        timeout.tv_sec = i_milliseconds / 1000;
+        timeout.tv_usec = (i_milliseconds % 1000) * 1000;
+        setsockopt(i_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(i_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+#elif _WIN32
+    const NIDAQmxSocket invalidSocket = INVALID_SOCKET;
+    const int sendFlags = 0;
+
+    void closeSocket(NIDAQmxSocket i_socket) {
+        closesocket(i_socket);
+    }
+
+    void setSocketTimeouts(NIDAQmxSocket i_socket, int i_milliseconds) {
+        DWORD timeout = i_milliseconds;
+        setsockopt(i_socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+        setsockopt(i_socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+    }
+#endif
+
+    /**
+     * How long a connection may stay silent before it is dropped, so that a stalled client cannot hold up stop().
+     */
+    const int connectionTimeoutMs = 1000;
+
+    /**
+     * The names of the phases, in the order of NIDAQmxMetrics::Phase.
+     */
+    const char *phaseNames[] = {"read", "calibrate", "publish", "event", "statistics", "spectrum", "preview"};
+
+    /**
+     * The quantiles of the phase latencies listed by collect().
+     */
+    const double latencyQuantiles[] = {0.5, 0.9, 0.99};
+    const char *latencyQuantileNames[] = {"0.5", "0.9", "0.99"};
+
+    /**
+     * Get the lowest time in nanoseconds of a latency bucket, the odd buckets starting half-way through their octave.
+     */
+    double latencyBucketStart(const int &i_bucket) {
+        return std::ldexp((i_bucket % 2) ? 1.5 : 1.0, i_bucket / 2);
+    }
+
+    /**
+     * Add a metric with a label.
+     */
+    void addMetric(vector<pair<string, double> > &o_metrics, const string &i_name, const string &i_label, const string &i_value, const double &i_metric) {
+        o_metrics.push_back(pair<string, double>(i_name + "{" + i_label + "=\"" + i_value + "\"}", i_metric));
+    }
+}
+
+
+/* *********************************************************************************************************************** */
+/* ******* Default Constructor.                                             ********************************************** */
+NIDAQmxMetrics::NIDAQmxMetrics() : scansRead(0), blocksRead(0), blocksPublished(0), blocksDropped(0), driverErrors(0), overruns(0), recoveries(0),
+        backlog(0), maxBacklog(0), scanRate(0), rateStart(0) {
+    for (int i = 0; i < NPhases; ++i) {
+        phaseTimes[i].store(0, std::memory_order_relaxed);
+        for (int j = 0; j < nLatencyBuckets; ++j) {
+            phaseLatencies[i][j].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    startTime = monotonicNanoseconds();
+    rateStart.store(startTime, std::memory_order_relaxed);
+    rateScans = 0;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Block times constructor.                                        ********************************************** */
+NIDAQmxMetrics::BlockTimes::BlockTimes() {
+    for (int i = 0; i < NPhases; ++i) {
+        times[i] = 0;
+        timed[i] = false;
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Add the time spent on a block in a phase.                        ********************************************** */
+uint64_t NIDAQmxMetrics::BlockTimes::add(const Phase &i_phase, const uint64_t &i_start) {
+    uint64_t end = monotonicNanoseconds();
+    times[i_phase] += end - i_start;
+    timed[i_phase] = true;
+
+    return end;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the name of a phase.                                         ********************************************** */
+const char *NIDAQmxMetrics::getPhaseName(const Phase &i_phase) {
+    return phaseNames[i_phase];
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Count a block read.                                              ********************************************** */
+void NIDAQmxMetrics::addBlockRead(const size_t &i_nScans, const size_t &i_backlog) {
+    uint64_t scans = scansRead.fetch_add(i_nScans, std::memory_order_relaxed) + i_nScans;
+    blocksRead.fetch_add(1, std::memory_order_relaxed);
+
+    backlog.store(i_backlog, std::memory_order_relaxed);
+    if (i_backlog > maxBacklog.load(std::memory_order_relaxed)) {      // Only the reading thread writes it
+        maxBacklog.store(i_backlog, std::memory_order_relaxed);
+    }
+
+    // The rate is updated once per interval rather than computed from the counters by each reader
+    uint64_t time = monotonicNanoseconds();
+    uint64_t start = rateStart.load(std::memory_order_relaxed);
+    if (time - start >= rateInterval) {
+        scanRate.store((scans - rateScans) * 1e9 / (time - start), std::memory_order_relaxed);
+        rateStart.store(time, std::memory_order_relaxed);
+        rateScans = scans;
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Count a block published.                                         ********************************************** */
+void NIDAQmxMetrics::addBlockPublished(const BlockTimes &i_times) {
+    for (int i = 0; i < NPhases; ++i) {
+        if (i_times.timed[i]) {
+            phaseTimes[i].fetch_add(i_times.times[i], std::memory_order_relaxed);
+            addLatency((Phase) i, i_times.times[i]);
+        }
+    }
+
+    blocksPublished.fetch_add(1, std::memory_order_relaxed);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Count a dropped block.                                           ********************************************** */
+void NIDAQmxMetrics::addBlockDropped(void) {
+    blocksDropped.fetch_add(1, std::memory_order_relaxed);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Count a failed read.                                             ********************************************** */
+void NIDAQmxMetrics::addDriverError(const bool &i_overrun) {
+    driverErrors.fetch_add(1, std::memory_order_relaxed);
+    if (i_overrun) {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Count a recovery.                                                ********************************************** */
+void NIDAQmxMetrics::addRecovery(void) {
+    recoveries.fetch_add(1, std::memory_order_relaxed);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Add the time spent in a phase.                                   ********************************************** */
+uint64_t NIDAQmxMetrics::addPhaseTime(const Phase &i_phase, const uint64_t &i_start) {
+    uint64_t end = monotonicNanoseconds();
+    phaseTimes[i_phase].fetch_add(end - i_start, std::memory_order_relaxed);
+    addLatency(i_phase, end - i_start);
+
+    return end;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Count the time a block spent in a phase.                         ********************************************** */
+void NIDAQmxMetrics::addLatency(const Phase &i_phase, const uint64_t &i_time) {
+    // The bucket is twice the octave of the time, plus one in its upper half
+    int bucket = 0;
+    if (i_time > 0) {
+        int octave = 0;
+        while (i_time >> (octave + 1)) {
+            ++octave;
+        }
+        bucket = 2 * octave + ((octave > 0) ? (int) ((i_time >> (octave - 1)) & 1) : 0);
+    }
+
+    phaseLatencies[i_phase][std::min(bucket, nLatencyBuckets - 1)].fetch_add(1, std::memory_order_relaxed);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the number of blocks timed in a phase.                       ********************************************** */
+uint64_t NIDAQmxMetrics::getPhaseCount(const Phase &i_phase) const {
+    uint64_t count = 0;
+    for (int j = 0; j < nLatencyBuckets; ++j) {
+        count += phaseLatencies[i_phase][j].load(std::memory_order_relaxed);
+    }
+
+    return count;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Estimate a percentile of a phase time.                           ********************************************** */
+double NIDAQmxMetrics::getPhaseLatency(const Phase &i_phase, const double &i_quantile) const {
+    uint64_t counts[nLatencyBuckets];
+    uint64_t total = 0;
+    for (int j = 0; j < nLatencyBuckets; ++j) {
+        counts[j] = phaseLatencies[i_phase][j].load(std::memory_order_relaxed);
+        total += counts[j];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // Interpolate linearly within the bucket holding the quantile
+    double rank = i_quantile * total;
+    double below = 0;
+    for (int j = 0; j < nLatencyBuckets; ++j) {
+        if ((counts[j] > 0) && (below + counts[j] >= rank)) {
+            double start = latencyBucketStart(j);
+            double fraction = std::max(rank - below, 0.0) / counts[j];
+            return (start + fraction * (latencyBucketStart(j + 1) - start)) * 1e-9;
+        }
+        below += counts[j];
+    }
+
+    return latencyBucketStart(nLatencyBuckets) * 1e-9;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* List the metrics.                                                ********************************************** */
+void NIDAQmxMetrics::collect(const vector<NIDAQmxOutput *> &i_outputs, vector<pair<string, double> > &o_metrics) const {
+    // A rate not updated for two intervals means the acquisition has stopped
+    uint64_t time = monotonicNanoseconds();
+    bool acquiring = (time - rateStart.load(std::memory_order_relaxed) < 2 * rateInterval);
+
+    o_metrics.clear();
+    o_metrics.push_back(pair<string, double>("nidaqmx_uptime_seconds", (time - startTime) * 1e-9));
+    o_metrics.push_back(pair<string, double>("nidaqmx_scans_read_total", (double) scansRead.load(std::memory_order_relaxed)));
+    o_metrics.push_back(pair<string, double>("nidaqmx_scans_per_second", acquiring ? scanRate.load(std::memory_order_relaxed) : 0));
+    o_metrics.push_back(pair<string, double>("nidaqmx_blocks_read_total", (double) blocksRead.load(std::memory_order_relaxed)));
+    o_metrics.push_back(pair<string, double>("nidaqmx_blocks_published_total", (double) blocksPublished.load(std::memory_order_relaxed)));
+    o_metrics.push_back(pair<string, double>("nidaqmx_blocks_dropped_total", (double) blocksDropped.load(std::memory_order_relaxed)));
+    o_metrics.push_back(pair<string, double>("nidaqmx_driver_errors_total", (double) driverErrors.load(std::memory_order_relaxed)));
+    o_metrics.push_back(pair<string, double>("nidaqmx_overruns_total", (double) overruns.load(std::memory_order_relaxed)));
+    o_metrics.push_back(pair<string, double>("nidaqmx_recoveries_total", (double) recoveries.load(std::memory_order_relaxed)));
+    o_metrics.push_back(pair<string, double>("nidaqmx_backlog_blocks", (double) backlog.load(std::memory_order_relaxed)));
+    o_metrics.push_back(pair<string, double>("nidaqmx_backlog_blocks_max", (double) maxBacklog.load(std::memory_order_relaxed)));
+
+    for (int i = 0; i < NPhases; ++i) {
+        addMetric(o_metrics, "nidaqmx_phase_seconds_total", "phase", phaseNames[i], phaseTimes[i].load(std::memory_order_relaxed) * 1e-9);
+    }
+    for (int i = 0; i < NPhases; ++i) {
+        uint64_t count = getPhaseCount((Phase) i);
+        addMetric(o_metrics, "nidaqmx_phase_blocks_total", "phase", phaseNames[i], (double) count);
+        for (int q = 0; (count > 0) && (q < 3); ++q) {
+            addMetric(o_metrics, "nidaqmx_phase_latency_seconds", "phase", string(phaseNames[i]) + "\",quantile=\"" + latencyQuantileNames[q],
+                    getPhaseLatency((Phase) i, latencyQuantiles[q]));
+        }
+    }
+
+    for (size_t i = 0; i < i_outputs.size(); ++i) {
+        const string &name = i_outputs[i]->getName();
+        addMetric(o_metrics, "nidaqmx_port_messages_total", "port", name, (double) i_outputs[i]->getSent());
+        addMetric(o_metrics, "nidaqmx_port_bytes_total", "port", name, (double) i_outputs[i]->getSentBytes());
+        addMetric(o_metrics, "nidaqmx_port_dropped_total", "port", name, (double) i_outputs[i]->getDropped());
+        addMetric(o_metrics, "nidaqmx_port_queued", "port", name, (double) i_outputs[i]->getQueued());
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Metrics server constructor.                                      ********************************************** */
+NIDAQmxMetricsServer::NIDAQmxMetricsServer(const NIDAQmxMetrics &aMetrics, const vector<NIDAQmxOutput *> &aOutputs)
+        : metrics(aMetrics), outputs(aOutputs), listener(invalidSocket), stopping(false) {
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Metrics server destructor.                                       ********************************************** */
+NIDAQmxMetricsServer::~NIDAQmxMetricsServer() {
+    stop();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Start serving.                                                   ********************************************** */
+bool NIDAQmxMetricsServer::start(const int &i_port) {
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        return false;
+    }
+#endif
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == invalidSocket) {
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+    // Loopback only, the metrics are not meant to leave the machine
+    sockaddr_in address;
+    address.sin_family = AF_INET;
+    address.sin_port = htons((unsigned short) i_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if ((bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) || (listen(listener, 4) != 0)) {
+        closeSocket(listener);
+        listener = invalidSocket;
+        return false;
+    }
+
+    stopping.store(false, std::memory_order_relaxed);
+    server = std::thread(&NIDAQmxMetricsServer::run, this);
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Stop serving.                                                    ********************************************** */
+void NIDAQmxMetricsServer::stop(void) {
+    if (server.joinable()) {
+        stopping.store(true, std::memory_order_relaxed);
+        server.join();
+    }
+
+    if (listener != invalidSocket) {
+        closeSocket(listener);
+        listener = invalidSocket;
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Serving thread loop.                                             ********************************************** */
+void NIDAQmxMetricsServer::run(void) {
+    while (!stopping.load(std::memory_order_relaxed)) {
+        // Wake up regularly to check whether the server is stopping
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(listener, &readable);
+        timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 200000;
+        if (select((int) listener + 1, &readable, NULL, NULL, &timeout) <= 0) {
+            continue;
+        }
+
+        NIDAQmxSocket connection = accept(listener, NULL, NULL);
+        if (connection != invalidSocket) {
+            serve(connection);
+            closeSocket(connection);
+        }
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Answer a connection.                                             ********************************************** */
+void NIDAQmxMetricsServer::serve(NIDAQmxSocket i_connection) {
+    setSocketTimeouts(i_connection, connectionTimeoutMs);
+
+    // The request is read but not parsed, every path gets the metrics
+    char request[1024];
+    if (recv(i_connection, request, sizeof(request), 0) <= 0) {
+        return;
+    }
+
+    vector<pair<string, double> > values;
+    metrics.collect(outputs, values);
+
+    string body;
+    char line[256];
+    for (size_t i = 0; i < values.size(); ++i) {
+        snprintf(line, sizeof(line), "%s %.10g\n", values[i].first.c_str(), values[i].second);
+        body += line;
+    }
+
+    snprintf(line, sizeof(line), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\nConnection: close\r\n\r\n",
+            (int) body.size());
+    string response = string(line) + body;
+
+    for (size_t sent = 0; sent < response.size(); ) {
+        int n = send(i_connection, response.c_str() + sent, (int) (response.size() - sent), sendFlags);
+        if (n <= 0) {
+            break;
+        }
+        sent += n;
+    }
+}
+/* *********************************************************************************************************************** */
@@ -20,18 +20,91 @@
 
 #include "NIDAQmxReaderModule.h"
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
+#include <yarp/os/Network.h>
 #include <yarp/os/Time.h>
 
+#include <NIDAQmxTask/include/NIDAQmxFunctions.h>
+
 using yarp::os::Bottle;
 using namespace nidaqmx;
 
+
+namespace {
+    /**
+     * Append copies of the values to themselves, so that they are repeated the given number of times.
+     */
+    template <class T>
+    void repeatValues(std::vector<T> &io_values, const size_t &i_copies) {
+        std::vector<T> values(io_values);
+        for (size_t k = 1; k < i_copies; ++k) {
+            io_values.insert(io_values.end(), values.begin(), values.end());
+        }
+    }
+
+    /**
+     * Build the block-diagonal matrix holding copies of a matrix.
+     */
+    DoubleMatrix2D repeatDiagonal(const DoubleMatrix2D &i_matrix, const size_t &i_nColumns, const size_t &i_copies) {
+        size_t nRows = i_matrix.size();
+        DoubleMatrix2D matrix(nRows * i_copies, std::vector<double>(i_nColumns * i_copies, 0.0));
+        for (size_t k = 0; k < i_copies; ++k) {
+            for (size_t i = 0; i < nRows; ++i) {
+                std::copy(i_matrix[i].begin(), i_matrix[i].end(), matrix[k*nRows + i].begin() + k*i_nColumns);
+            }
+        }
+
+        return matrix;
+    }
+}
+
+
 /* *********************************************************************************************************************** */
 /* ******* Constructor                                                      ********************************************** */   
-NIDAQmxReaderModule::NIDAQmxReaderModule() : RFModule() {
+NIDAQmxReaderModule::NIDAQmxReaderModule() : RFModule()
+        , quantiserPending(false)
+        , samplingChange(1, 20000, 10, 100000)
+        , samplingChangePending(false)
+        , samplingChangeResult(false)
+        , samplingChangeDone(0)
+        , recoveryLogLimiter(5.0)
+        , backlogLogLimiter(1.0) {
     dbgTag = "NIDAQmxReaderModule: ";
+    DAQTask = NULL;
+    DAQStrand = NULL;
+    droppedDiscontinuity = 0;
+    DAQNOutputs = 0;
+    eventRecorder = NULL;
+    eventPreTrigger = 0;
+    eventPostTrigger = 0;
+    windowStatistics = NULL;
+    statisticsWindow = 0;
+    spectrum = NULL;
+    spectrumFFTSize = 0;
+    spectrumAverages = 0;
+    realPreview = NULL;
+    analogPreview = NULL;
+    analogPreviewFed = false;
+    analogPreviewDiscontinuity = 0;
+    realPreviewDiscontinuity = 0;
+    realQuantiser = NULL;
+    deltaCompression = false;
+    metricsServer = NULL;
+    previewRate = 0;
+    lastScan = 0;
+    recoveryBudget = 5.0;
+    recoveryTimeouts = 3;
+    transientErrors = 0;
+    DAQTaskLost = false;
+    gapStart = 0;
+    gapError = 0;
+    startTime = 0;
+    nRecoveries = 0;
+    lastGap = 0;
+    totalDowntime = 0;
 }
 /* *********************************************************************************************************************** */
 
@@ -50,6 +123,30 @@ double NIDAQmxReaderModule::getPeriod() { return period; }
 /* *********************************************************************************************************************** */
 
 
+/* *********************************************************************************************************************** */
+/* ******* Get the task configuration                                       ********************************************** */
+const nidaqmx::NIDAQmxTaskParams &NIDAQmxReaderModule::getTaskConfig(void) const {
+    return DAQTaskConfig;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the metrics                                                  ********************************************** */
+const NIDAQmxMetrics &NIDAQmxReaderModule::getMetrics(void) const {
+    return metrics;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Get the output ports                                             ********************************************** */
+const std::vector<NIDAQmxOutput *> &NIDAQmxReaderModule::getOutputs(void) const {
+    return outputs;
+}
+/* *********************************************************************************************************************** */
+
+
 /* *********************************************************************************************************************** */
 /* ******* Configure module                                                 ********************************************** */   
 bool NIDAQmxReaderModule::configure(yarp::os::ResourceFinder &rf) {
@@ -64,10 +161,85 @@ bool NIDAQmxReaderModule::configure(yarp::os::ResourceFinder &rf) {
     moduleName = rf.check("name", Value("NIDAQmxReader"), "The module name.").asString().c_str();
     period = rf.check("period", 1.0).asDouble();
     robotName = rf.check("robot", Value("icub"), "The robot name.").asString().c_str();
+    string verbosity = rf.check("verbosity", Value("info"), "The log verbosity (error, warning, info, debug).").asString().c_str();
+    if (!NIDAQmxLog::setLevel(verbosity)) {
+        cout << moduleName << ": Invalid verbosity (" << verbosity << "), expecting one of error, warning, info, debug. \n";
+        return false;
+    }
+    string compression = rf.check("compression", Value("none"), "The encoding of the quantised port (none, delta).").asString().c_str();
+    if ((compression != "none") && (compression != "delta")) {
+        cout << moduleName << ": Invalid compression (" << compression << "), expecting one of none, delta. \n";
+        return false;
+    }
+    deltaCompression = (compression == "delta");
+    string processing = rf.check("processing", Value("inline"), "Where the blocks are processed (inline, pool).").asString().c_str();
+    if ((processing != "inline") && (processing != "pool")) {
+        cout << moduleName << ": Invalid processing (" << processing << "), expecting one of inline, pool. \n";
+        return false;
+    }
+
+    // The simulated device stands in for the DAQ card, e.g. for benchmarking
+    DAQTaskConfig.DAQSimulated = rf.check("simulate");
 
     // Open ports
-    portNIDAQmxReaderOutAnalog.open("/NIDAQmxReader/data/analog:o");
-    portNIDAQmxReaderOutReal.open("/NIDAQmxReader/data/real:o");
+    // Each port is written by its own thread, with the policy applied once its queue is full
+    Bottle &DAQOutputsConf = rf.findGroup("DAQOutputs");
+    if (!(openOutput(portNIDAQmxReaderOutAnalog, "/NIDAQmxReader/data/analog:o", DAQOutputsConf, "analog", OutputDropOldest, 4096)
+            && openOutput(portNIDAQmxReaderOutReal, "/NIDAQmxReader/data/real:o", DAQOutputsConf, "real", OutputDropOldest, 4096)
+            && openOutput(portNIDAQmxReaderOutAnalogBlock, "/NIDAQmxReader/data/analogBlock:o", DAQOutputsConf, "analogBlock", OutputStrict, 64)
+            && openOutput(portNIDAQmxReaderOutRealBlock, "/NIDAQmxReader/data/realBlock:o", DAQOutputsConf, "realBlock", OutputStrict, 64)
+            && openOutput(portNIDAQmxReaderOutRealQuantised, "/NIDAQmxReader/data/realQuantised:o", DAQOutputsConf, "realQuantised", OutputStrict, 64)
+            && openOutput(portNIDAQmxReaderOutEvent, "/NIDAQmxReader/data/event:o", DAQOutputsConf, "event", OutputStrict, 16)
+            && openOutput(portNIDAQmxReaderOutStats, "/NIDAQmxReader/data/stats:o", DAQOutputsConf, "stats", OutputStrict, 16)
+            && openOutput(portNIDAQmxReaderOutSpectrum, "/NIDAQmxReader/data/spectrum:o", DAQOutputsConf, "spectrum", OutputStrict, 16)
+            && openOutput(portNIDAQmxReaderOutAnalogPreview, "/NIDAQmxReader/data/analogPreview:o", DAQOutputsConf, "analogPreview", OutputDropOldest, 64)
+            && openOutput(portNIDAQmxReaderOutRealPreview, "/NIDAQmxReader/data/realPreview:o", DAQOutputsConf, "realPreview", OutputDropOldest, 64)
+            && openOutput(portNIDAQmxReaderOutGap, "/NIDAQmxReader/data/gap:o", DAQOutputsConf, "gap", OutputStrict, 16)
+            && openOutput(portNIDAQmxReaderOutSaturation, "/NIDAQmxReader/data/saturation:o", DAQOutputsConf, "saturation", OutputStrict, 16))) {
+        cout << moduleName << ": Invalid output policy under [DAQOutputs], expecting (strict depth), (dropOldest depth) or (latest). \n";
+        return false;
+    }
+
+    // The ports whose readers decode the scan envelope instead of a yarp::os::Stamp
+    Bottle *scanEnvelopeList = rf.find("scanEnvelope").asList();
+    for (int i = 0; scanEnvelopeList && (i < scanEnvelopeList->size()); ++i) {
+        string key = scanEnvelopeList->get(i).asString().c_str();
+        NIDAQmxOutput *output = findOutput(key);
+        if (!output) {
+            cout << moduleName << ": Invalid output port (" << key << ") in scanEnvelope. \n";
+            return false;
+        }
+        scanEnvelopeOutputs.push_back(output);
+    }
+
+    // Metrics endpoint, only started once the task is ready
+    Bottle &DAQMetricsConf = rf.findGroup("DAQMetrics");
+    int httpPort = DAQMetricsConf.check("httpPort", Value(0), "The local port of the metrics endpoint.").asInt();
+    if (!DAQMetricsConf.isNull() && (httpPort <= 0)) {
+        cout << moduleName << ": Invalid metrics port (" << httpPort << ") under [DAQMetrics]. \n";
+        return false;
+    }
+
+    // Multicast profile, each entry being a port key followed by its initial readers
+    Bottle &DAQMulticastConf = rf.findGroup("DAQMulticast");
+    for (int i = 1; i < DAQMulticastConf.size(); ++i) {
+        Bottle *multicastEntry = DAQMulticastConf.get(i).asList();
+        string key = multicastEntry ? multicastEntry->get(0).asString().c_str() : "";
+        if (!findOutput(key)) {
+            cout << moduleName << ": Invalid output port (" << key << ") under [DAQMulticast]. \n";
+            return false;
+        }
+        multicastOutputs.push_back(key);
+
+        // Readers which are not running yet can subscribe later
+        Bottle *readersList = multicastEntry->get(1).asList();
+        for (int j = 0; readersList && (j < readersList->size()); ++j) {
+            string reader = readersList->get(j).asString().c_str();
+            if (!connectMulticast(key, reader)) {
+                cout << moduleName << ": Could not connect " << reader << " to " << key << " by multicast. \n";
+            }
+        }
+    }
     
     // DAQ task attributes
     size_t DAQNChannels;
@@ -131,6 +303,13 @@ bool NIDAQmxReaderModule::configure(yarp::os::ResourceFinder &rf) {
        DAQTaskConfig.DAQSamplingRate = DAQSamplingConf.check("samplingRate", 20000, "The sampling rate in Hz.").asDouble();
        DAQTaskConfig.DAQSamplingTimeout = DAQSamplingConf.check("timeout", 10, "The sampling timeout in ms.").asDouble();
        DAQTaskConfig.DAQSamplingBufferSize = DAQSamplingConf.check("bufferSize", 100000, "The sampling buffer size.").asInt();
+       // Triggered acquisition
+       DAQTaskConfig.DAQTriggerType = DAQSamplingConf.check("triggerType", Value("None"), "The trigger type (None, AnalogEdge, DigitalEdge).").asString().c_str();
+       DAQTaskConfig.DAQTriggerSource = DAQSamplingConf.check("triggerSource", Value("ai0"), "The trigger source.").asString().c_str();
+       DAQTaskConfig.DAQTriggerSlope = DAQSamplingConf.check("triggerSlope", Value("Rising"), "The trigger slope (Rising, Falling).").asString().c_str();
+       DAQTaskConfig.DAQTriggerLevel = DAQSamplingConf.check("triggerLevel", 0.0, "The analog trigger level.").asDouble();
+       DAQTaskConfig.DAQPreTriggerSamples = DAQSamplingConf.check("preTriggerSamples", 1000, "The number of samples per channel before the trigger.").asInt();
+       DAQTaskConfig.DAQPostTriggerSamples = DAQSamplingConf.check("postTriggerSamples", 1000, "The number of samples per channel after the trigger.").asInt();
     } else {    // Can't find sampling configuration in ini file
         cout << moduleName << ": Could not find the sampling configuration details [DAQSampling] in the ini file provided. \n";
         cout << moduleName << ": Using default sampling configuration values. \n";
@@ -139,6 +318,19 @@ bool NIDAQmxReaderModule::configure(yarp::os::ResourceFinder &rf) {
         DAQTaskConfig.DAQSamplingRate = 20000;
         DAQTaskConfig.DAQSamplingTimeout = 10;
         DAQTaskConfig.DAQSamplingBufferSize = 100000;
+        DAQTaskConfig.DAQTriggerType = "None";
+        DAQTaskConfig.DAQTriggerSource = "ai0";
+        DAQTaskConfig.DAQTriggerSlope = "Rising";
+        DAQTaskConfig.DAQTriggerLevel = 0.0;
+        DAQTaskConfig.DAQPreTriggerSamples = 1000;
+        DAQTaskConfig.DAQPostTriggerSamples = 1000;
+    }
+    if (DAQTaskConfig.DAQSimulated && rf.check("rate")) {     // The simulated device runs at any rate
+        DAQTaskConfig.DAQSamplingRate = rf.find("rate").asDouble();
+        if (DAQTaskConfig.DAQSamplingRate <= 0) {
+            cout << moduleName << ": The simulated sampling rate must be positive. \n";
+            return false;
+        }
     }
 
     // DAQ Sensor calibration data
@@ -150,23 +342,8 @@ bool NIDAQmxReaderModule::configure(yarp::os::ResourceFinder &rf) {
         Bottle *DAQSensorCalibMatrixList = DAQSensorCalib.find("calibMatrix").asList();
 
         if (!(DAQSensorCalibScalesList->isNull() || DAQSensorCalibMatrixList->isNull())) {    // Check for parameter existence
-            if (DAQNChannels == DAQSensorCalibScalesList->size()
-                    && DAQNChannels == (DAQSensorCalibMatrixList->size() / DAQNChannels)) {
-                // Initialise vectors
-                DAQTaskConfig.DAQSensorCalibScales = vector<double>(DAQNChannels);
-                DAQTaskConfig.DAQSensorCalibMatrix = DoubleMatrix2D(DAQNChannels);
-                // Fill vectors from ini file
-                for (size_t i = 0; i < DAQNChannels; ++i) {
-                    DAQTaskConfig.DAQSensorCalibScales[i] = DAQSensorCalibScalesList->get(i).asDouble();
-                    DAQTaskConfig.DAQSensorCalibMatrix[i] = vector<double> (DAQNChannels);
-                }
-
-                for (size_t i = 0; i < DAQNChannels; ++i) {     // Matrix rows
-                    for (size_t j = 0; j < DAQNChannels; ++j) { // Matrix cols
-                        DAQTaskConfig.DAQSensorCalibMatrix[i][j] = DAQSensorCalibMatrixList->get((i*DAQNChannels)+j).asDouble();
-                    }
-                }
-            } else {    // Invalid size of scales/calibration matrix
+            if (!parseCalibration(*DAQSensorCalibScalesList, *DAQSensorCalibMatrixList, DAQNChannels,
+                        DAQTaskConfig.DAQSensorCalibScales, DAQTaskConfig.DAQSensorCalibMatrix)) {    // Invalid size of scales/calibration matrix
                 cout << moduleName << ": Invalid number of elements in either the calibration scales or the calibration matrix. \n";
                 cout << moduleName << ": Please check the configuration .ini file provided. \n";
                 return false;
@@ -175,12 +352,149 @@ bool NIDAQmxReaderModule::configure(yarp::os::ResourceFinder &rf) {
             cout << moduleName << ": Could not find the DAQ sensor calibration matrix or the calibration scales. \n";
             return false;
         }
+
+        // Optional bias and output transform, composed with the calibration by the DAQ task
+        DAQNOutputs = DAQTaskConfig.DAQSensorCalibScales.size();
+        Bottle *DAQSensorBiasList = DAQSensorCalib.find("bias").asList();
+        if (DAQSensorBiasList) {
+            if (DAQSensorBiasList->size() != (int) DAQNOutputs) {
+                cout << moduleName << ": Expecting one bias value per calibration scale. \n";
+                return false;
+            }
+            DAQTaskConfig.DAQSensorBias = vector<double>(DAQNOutputs);
+            for (size_t i = 0; i < DAQNOutputs; ++i) {
+                DAQTaskConfig.DAQSensorBias[i] = DAQSensorBiasList->get(i).asDouble();
+            }
+        }
+        Bottle *DAQOutputTransformList = DAQSensorCalib.find("outputTransform").asList();
+        if (DAQOutputTransformList) {
+            if (DAQOutputTransformList->size() != (int) (DAQNOutputs * DAQNOutputs)) {
+                cout << moduleName << ": Expecting an output transform of " << DAQNOutputs << "x" << DAQNOutputs << " values. \n";
+                return false;
+            }
+            DAQTaskConfig.DAQOutputTransform = DoubleMatrix2D(DAQNOutputs, vector<double>(DAQNOutputs));
+            for (size_t i = 0; i < DAQNOutputs; ++i) {
+                for (size_t j = 0; j < DAQNOutputs; ++j) {
+                    DAQTaskConfig.DAQOutputTransform[i][j] = DAQOutputTransformList->get((i*DAQNOutputs)+j).asDouble();
+                }
+            }
+        }
     } else {    // Can't find calibration matrix and/or scales
         cout << moduleName << ": Could not find the DAQ sensor calibration details [DAQSensorCalib] in the ini file provided. \n";
         cout << moduleName << ": Please refer to the documentation. \n";
         return false;
     }
 
+    // DAQ counters, acquired alongside the analog channels
+    Bottle &DAQCountersConf = rf.findGroup("DAQCounters");
+    if (!DAQCountersConf.isNull()) {    // Check for parameter existence
+        // DAQ counters
+        Bottle *DAQCounterChannelsList = DAQCountersConf.find("channels").asList();
+        // DAQ counter types
+        Bottle *DAQCounterTypesList = DAQCountersConf.find("channelType").asList();
+        // DAQ counter scales
+        Bottle *DAQCounterScalesList = DAQCountersConf.find("scales").asList();
+
+        if (!(DAQCounterChannelsList->isNull() || DAQCounterTypesList->isNull() || DAQCounterScalesList->isNull())) {   // Check for parameter existence
+            int DAQNCounters = DAQCounterChannelsList->size();
+            if ((DAQNCounters == DAQCounterTypesList->size()) && (DAQNCounters == DAQCounterScalesList->size())) {    // Check for same number of elements
+                DAQTaskConfig.DAQCounterChannels = vector<string>(DAQNCounters);
+                DAQTaskConfig.DAQCounterChannelTypes = vector<string>(DAQNCounters);
+                DAQTaskConfig.DAQCounterScales = vector<double>(DAQNCounters);
+                for (int i = 0; i < DAQNCounters; ++i) {
+                    DAQTaskConfig.DAQCounterChannels[i] = DAQCounterChannelsList->get(i).asString();
+                    DAQTaskConfig.DAQCounterChannelTypes[i] = DAQCounterTypesList->get(i).asString();
+                    DAQTaskConfig.DAQCounterScales[i] = DAQCounterScalesList->get(i).asDouble();
+                }
+            } else {    // Parameter lists contain different number of elements
+                cout << moduleName << ": The counter parameter lists under [DAQCounters] contain different numbers of elements. \n";
+                return false;
+            }
+        } else {    // Can't find one or more counter parameters
+            cout << moduleName << ": Could not find one or more configuration parameters in the config file specified under the [DAQCounters] parameter group. \n";
+            cout << moduleName << ": Expecting the following parameter lists: channels, channelType, scales. \n";
+            return false;
+        }
+    }
+
+    // Threshold-triggered event snapshots
+    Bottle &DAQEventsConf = rf.findGroup("DAQEvents");
+    if (!DAQEventsConf.isNull()) {      // Check for parameter existence
+        Bottle *DAQEventThresholdsList = DAQEventsConf.find("thresholds").asList();
+        eventPreTrigger = DAQEventsConf.check("preTrigger", 0.2, "The time kept before an event in seconds.").asDouble();
+        eventPostTrigger = DAQEventsConf.check("postTrigger", 0.2, "The time captured after an event in seconds.").asDouble();
+
+        if (DAQEventThresholdsList && (DAQEventThresholdsList->size() == (int) DAQNOutputs) && (eventPreTrigger >= 0) && (eventPostTrigger >= 0)) {
+            eventThresholds = vector<double>(DAQNOutputs);
+            for (size_t i = 0; i < DAQNOutputs; ++i) {
+                eventThresholds[i] = DAQEventThresholdsList->get(i).asDouble();
+            }
+        } else {
+            cout << moduleName << ": Expecting one event threshold per calibrated output and non-negative trigger times under [DAQEvents]. \n";
+            return false;
+        }
+    }
+
+    // More sensors like the configured one on the simulated device
+    if (DAQTaskConfig.DAQSimulated && rf.check("channels")) {
+        int nSimulatedChannels = rf.find("channels").asInt();
+        if ((nSimulatedChannels < (int) DAQNChannels) || (nSimulatedChannels % DAQNChannels != 0)) {
+            cout << moduleName << ": The number of simulated channels must be a multiple of the " << DAQNChannels << " configured channels. \n";
+            return false;
+        }
+        replicateSensor(nSimulatedChannels / DAQNChannels);
+    }
+
+    // Windowed statistics
+    Bottle &DAQStatisticsConf = rf.findGroup("DAQStatistics");
+    if (!DAQStatisticsConf.isNull()) {  // Check for parameter existence
+        statisticsWindow = DAQStatisticsConf.check("window", 0.1, "The statistics window in seconds.").asDouble();
+        if (statisticsWindow <= 0) {
+            cout << moduleName << ": The statistics window under [DAQStatistics] must be positive. \n";
+            return false;
+        }
+    }
+
+    // Spectral analysis
+    Bottle &DAQSpectrumConf = rf.findGroup("DAQSpectrum");
+    if (!DAQSpectrumConf.isNull()) {    // Check for parameter existence
+        spectrumFFTSize = DAQSpectrumConf.check("fftSize", 1024, "The FFT length in scans.").asInt();
+        spectrumAverages = DAQSpectrumConf.check("averages", 8, "The number of segments averaged for each estimate.").asInt();
+        Bottle *DAQSpectrumBandsList = DAQSpectrumConf.find("bands").asList();
+
+        if (DAQSpectrumBandsList && (DAQSpectrumBandsList->size() > 0) && (DAQSpectrumBandsList->size() % 2 == 0)
+                && (spectrumFFTSize > 1) && (spectrumAverages > 0)) {
+            spectrumBands = vector<double>(DAQSpectrumBandsList->size());
+            for (int i = 0; i < DAQSpectrumBandsList->size(); ++i) {
+                spectrumBands[i] = DAQSpectrumBandsList->get(i).asDouble();
+            }
+        } else {
+            cout << moduleName << ": Expecting a positive fftSize and averages and a list of band edge pairs under [DAQSpectrum]. \n";
+            return false;
+        }
+    }
+
+    // Display-rate preview
+    Bottle &DAQPreviewConf = rf.findGroup("DAQPreview");
+    if (!DAQPreviewConf.isNull()) {     // Check for parameter existence
+        previewRate = DAQPreviewConf.check("rate", 60, "The preview rate in Hz.").asDouble();
+        if (previewRate <= 0) {
+            cout << moduleName << ": The preview rate under [DAQPreview] must be positive. \n";
+            return false;
+        }
+    }
+
+    // Recovery from driver errors
+    Bottle &DAQRecoveryConf = rf.findGroup("DAQRecovery");
+    if (!DAQRecoveryConf.isNull()) {    // Check for parameter existence
+        recoveryBudget = DAQRecoveryConf.check("budget", 5.0, "The time allowed to each recovery in seconds.").asDouble();
+        recoveryTimeouts = DAQRecoveryConf.check("timeouts", 3, "The number of consecutive read timeouts before restarting the task.").asInt();
+        if ((recoveryBudget <= 0) || (recoveryTimeouts < 1)) {
+            cout << moduleName << ": Expecting a positive budget and at least one timeout under [DAQRecovery]. \n";
+            return false;
+        }
+    }
+
 #if 0    
     printf("Calibration matrix: \n");
     for (DoubleMatrix2D::iterator it = DAQSensorCalibMatrix.begin(); it != DAQSensorCalibMatrix.end(); ++it) {
@@ -206,11 +520,50 @@ bool NIDAQmxReaderModule::configure(yarp::os::ResourceFinder &rf) {
 
     /* ******* Build DAQ Task object.                            ******* */
     DAQTask = new NIDAQmxTask(DAQTaskConfig);    // Build task
+    createStages();
+
+    // Quantise the real values over the range the analog channels can reach
+    vector<double> realMin, realMax;
+    computeQuantiserRanges(DAQTaskConfig.DAQSensorCalibScales, DAQTaskConfig.DAQSensorCalibMatrix, realMin, realMax);
+    realQuantiser = new NIDAQmxQuantiser(realMin, realMax);
+
+    // The calibration is only computed when the real values are needed
+    DAQTask->setCalibrationDeferred(true);
+
+    // Calibrate and publish on the shared worker pool, the reading thread only reads
+    if (processing == "pool") {
+        DAQStrand = new NIDAQmxStrand();
+        for (size_t i = 0; i < nBlockJobs; ++i) {
+            blockJobs.push_back(new BlockJob(this));
+        }
+        freeBlockJobs = blockJobs;
+    }
 
 
     /* ******* Initialise the DAQ Task.                         ******* */
-    if (DAQTask->initialiseDAQTask()) {
-        yarp::os::Time::delay(1);
+    // Wait for the first samples instead of sleeping for a fixed time
+    if (DAQTask->initialiseDAQTask() && DAQTask->waitDAQTaskReady(1.0)) {
+        const NIDAQmxInitTimes &initTimes = DAQTask->getInitTimes();
+        cout << moduleName << ": DAQ task ready. Task " << initTimes.createTask * 1000 << " ms, channels " << initTimes.createChannels * 1000
+            << " ms, timing " << initTimes.configureTiming * 1000 << " ms, start " << initTimes.startTask * 1000
+            << " ms, first samples " << initTimes.waitReady * 1000 << " ms. \n";
+        startTime = monotonicNow();
+
+        // Serve the metrics of the output ports opened above
+        if (!DAQMetricsConf.isNull()) {
+            metricsServer = new NIDAQmxMetricsServer(metrics, outputs);
+            if (!metricsServer->start(httpPort)) {
+                cout << moduleName << ": Could not serve the metrics on port " << httpPort << " under [DAQMetrics]. \n";
+                delete metricsServer;
+                metricsServer = NULL;
+                return false;
+            }
+        }
+
+        // Accept reconfiguration requests only once the task exists
+        portNIDAQmxReaderRPC.open("/NIDAQmxReader/rpc:i");
+        attach(portNIDAQmxReaderRPC);
+
         return true;
     } else {
         return false;
@@ -222,46 +575,83 @@ bool NIDAQmxReaderModule::configure(yarp::os::ResourceFinder &rf) {
 /* *********************************************************************************************************************** */
 /* ******* Update module                                                    ********************************************** */   
 bool NIDAQmxReaderModule::updateModule() {
-    using std::vector;
-    using yarp::sig::Vector;
+    /* ******* Apply a pending sampling reconfiguration.        ******* */
+    if (samplingChangePending.load(std::memory_order_acquire)) {
+        applySamplingChange();
+    }
 
-    /* ******* Initialise the DAQ Task.                         ******* */
-    NIDAQmxResults res;
-    if (DAQTask->runDAQTask(res)) {
-        if (res.analogValues.size() > 0) {
-            // Output data on port
-            int nChannels = DAQTaskConfig.DAQChannels.size();
-            int samplesPerChannel = DAQTaskConfig.DAQSamplesPerChannel;
-            int totSamples = nChannels * samplesPerChannel;
-
-            //for (size_t i = 0; i < samplesPerChannel; ++i) {
-            for (size_t i = 0; i < res.analogValues.size() / nChannels; ++i) {
-                // Store timestamp
-                portStamp.update();
-
-                Vector &outAnalog = portNIDAQmxReaderOutAnalog.prepare();
-                Vector &outReal = portNIDAQmxReaderOutReal.prepare();
-                outAnalog.clear();
-                outReal.clear();
-
-                for (int j = 0; j < nChannels; ++j) {
-                    outAnalog.push_back(res.analogValues[nChannels*i+j]);
-                    outReal.push_back(res.realValues[nChannels*i+j]);
-                }
+    /* ******* Restart a failed DAQ task.                       ******* */
+    if (DAQTaskLost && !recoverTask()) {
+        return true;
+    }
 
-                // Attach timestamp
-                portNIDAQmxReaderOutAnalog.setEnvelope(portStamp);
-                portNIDAQmxReaderOutReal.setEnvelope(portStamp);
+    /* ******* Read the next block.                             ******* */
+    size_t nChannels = DAQTaskConfig.DAQChannels.size();
+    uint64_t readStart = monotonicNanoseconds();
+    if (DAQStrand) {
+        // Hand the block over to the strand and go back to reading
+        // Once all the jobs are in use the block is still read, so that the driver buffer does not overflow, but dropped
+        BlockJob *job = NULL;
+        blockJobsMutex.lock();
+        if (!freeBlockJobs.empty()) {
+            job = freeBlockJobs.back();
+            freeBlockJobs.pop_back();
+        }
+        blockJobsMutex.unlock();
 
-                // Write data
-                portNIDAQmxReaderOutAnalog.write();
-                portNIDAQmxReaderOutReal.write();
+        NIDAQmxResults &results = job ? job->results : droppedResults;
+        if (!DAQTask->runDAQTask(results)) {
+            if (job) {
+                job->release();
             }
+            handleReadFailure();
+
+            return true;
         }
-    } else {        // Could not run task, close module
-        std::cerr << dbgTag << "Error: Could not run the DAQ Task. \n";
+        transientErrors = 0;
 
-        return false;
+        if (results.analogValues.empty()) {
+            if (job) {
+                job->release();
+            }
+            return true;
+        }
+
+        size_t nPending = DAQStrand->getNPending();
+        metrics.addPhaseTime(NIDAQmxMetrics::PhaseRead, readStart);
+        metrics.addBlockRead(results.analogValues.size() / nChannels, nPending);
+
+        // The workers are not keeping up with the acquisition, the next block published follows lost scans
+        if (!job) {
+            unsigned int suppressed;
+            metrics.addBlockDropped();
+            droppedDiscontinuity |= results.discontinuity | DiscontinuityOverrun;
+            if (backlogLogLimiter.allow(suppressed)) {
+                NIDAQmxLog::log(NIDAQmxLog::Warning, "%sWarning: %d blocks are waiting to be processed, dropped a block of %d scans (%u warnings not reported).",
+                        dbgTag.c_str(), (int) nPending, (int) (results.analogValues.size() / nChannels), suppressed);
+            }
+
+            return true;
+        }
+
+        job->readTime = yarp::os::Time::now();
+        job->results.discontinuity |= droppedDiscontinuity;
+        droppedDiscontinuity = 0;
+        DAQStrand->post(job);
+
+        return true;
+    }
+
+    NIDAQmxResults res;
+    if (DAQTask->runDAQTask(res)) {
+        transientErrors = 0;
+        if (res.analogValues.size() > 0) {
+            metrics.addPhaseTime(NIDAQmxMetrics::PhaseRead, readStart);
+            metrics.addBlockRead(res.analogValues.size() / nChannels, 0);
+            processResults(res, yarp::os::Time::now());
+        }
+    } else {        // Could not run task, recover it without closing the module
+        handleReadFailure();
     }
 
     return true;
@@ -273,6 +663,11 @@ bool NIDAQmxReaderModule::updateModule() {
 /* ******* Close module                                                     ********************************************** */   
 bool NIDAQmxReaderModule::close() {
     std::cout << dbgTag << "Closing module. \n";
+
+    // Finish processing the blocks already read
+    if (DAQStrand) {
+        DAQStrand->drain();
+    }
     
     // Stop the currently running task
     if (!DAQTask->stopDAQTask()) {
@@ -283,12 +678,32 @@ bool NIDAQmxReaderModule::close() {
         std::cout << dbgTag << "Can't clear the DAQ Task. \n";
     }
     freeMemory();
+
+    // The endpoint reads the port counters
+    if (metricsServer) {
+        delete metricsServer;
+        metricsServer = NULL;
+    }
  
     // Close ports
     portNIDAQmxReaderOutAnalog.close();
     portNIDAQmxReaderOutReal.close();
+    portNIDAQmxReaderOutAnalogBlock.close();
+    portNIDAQmxReaderOutRealBlock.close();
+    portNIDAQmxReaderOutRealQuantised.close();
+    portNIDAQmxReaderOutEvent.close();
+    portNIDAQmxReaderOutStats.close();
+    portNIDAQmxReaderOutSpectrum.close();
+    portNIDAQmxReaderOutAnalogPreview.close();
+    portNIDAQmxReaderOutRealPreview.close();
+    portNIDAQmxReaderOutGap.close();
+    portNIDAQmxReaderOutSaturation.close();
+    portNIDAQmxReaderRPC.close();
 
     std::cout << dbgTag << "Closed. \n";
+
+    // Write out any message still queued by the DAQ task
+    NIDAQmxLog::flush();
     
     return true;
 }
@@ -303,6 +718,22 @@ bool NIDAQmxReaderModule::interruptModule() {
     // Interrupt ports
     portNIDAQmxReaderOutAnalog.interrupt();
     portNIDAQmxReaderOutReal.interrupt();
+    portNIDAQmxReaderOutAnalogBlock.interrupt();
+    portNIDAQmxReaderOutRealBlock.interrupt();
+    portNIDAQmxReaderOutRealQuantised.interrupt();
+    portNIDAQmxReaderOutEvent.interrupt();
+    portNIDAQmxReaderOutStats.interrupt();
+    portNIDAQmxReaderOutSpectrum.interrupt();
+    portNIDAQmxReaderOutAnalogPreview.interrupt();
+    portNIDAQmxReaderOutRealPreview.interrupt();
+    portNIDAQmxReaderOutGap.interrupt();
+    portNIDAQmxReaderOutSaturation.interrupt();
+    portNIDAQmxReaderRPC.interrupt();
+
+    // Release the rpc call waiting for a sampling reconfiguration, if any
+    if (samplingChangePending.exchange(false, std::memory_order_acq_rel)) {
+        samplingChangeDone.post();
+    }
 
     std::cout << dbgTag << "Interrupted. \n";
 
@@ -314,15 +745,797 @@ bool NIDAQmxReaderModule::interruptModule() {
 /* *********************************************************************************************************************** */
 /* ******* Respond to rpc calls                                             ********************************************** */   
 bool NIDAQmxReaderModule::respond(const Bottle &command, Bottle &reply) {
+    using std::string;
+    using std::vector;
+
+    string cmd = command.get(0).asString().c_str();
+    reply.clear();
+
+    if (cmd == "help") {
+        reply.addString("setCalib (scales) (calibMatrix): Replace the sensor calibration without stopping the acquisition, keeping the bias and output transform.");
+        reply.addString("setSampling samplesPerChannel samplingRate [bufferSize]: Restart the DAQ task with new sampling parameters.");
+        reply.addString("getOutputs: Get the policy, queue depth, queued and dropped messages of each output port.");
+        reply.addString("subscribe port reader: Connect a reader to an output port listed under [DAQMulticast], by multicast.");
+        reply.addString("getMetrics: Get the counters and rates of the acquisition, the processing and the output ports.");
+        reply.addString("getAvailability: Get the number of recoveries, the last and total gap durations and the fraction of time spent acquiring.");
+    } else if (cmd == "setCalib") {
+        // Hot-swap the calibration, the processing thread picks it up on the next block
+        Bottle *scalesList = command.get(1).asList();
+        Bottle *matrixList = command.get(2).asList();
+        vector<double> scales;
+        DoubleMatrix2D matrix;
+
+        // Held until the quantiser ranges are set too, so that the processing thread swaps in both at once
+        quantiserMutex.lock();
+        bool result = scalesList && matrixList
+                && parseCalibration(*scalesList, *matrixList, DAQTaskConfig.DAQChannels.size(), scales, matrix)
+                && (scales.size() == DAQNOutputs)
+                && DAQTask->setCalibrationConfig(scales, matrix, DAQTaskConfig.DAQSensorBias, DAQTaskConfig.DAQOutputTransform);
+        if (result) {
+            DAQTaskConfig.DAQSensorCalibScales = scales;
+            DAQTaskConfig.DAQSensorCalibMatrix = matrix;
+            computeQuantiserRanges(scales, matrix, quantiserMin, quantiserMax);
+            quantiserPending.store(true, std::memory_order_release);
+        }
+        quantiserMutex.unlock();
+
+        reply.addString(result ? "ok" : "failed");
+    } else if (cmd == "setSampling") {
+        // The timing change must be applied by the reading thread, wait for it to do so
+        if ((command.size() < 3) || (command.get(1).asInt() <= 0) || (command.get(2).asDouble() <= 0)) {
+            reply.addString("failed");
+            return true;
+        }
+
+        samplingChangeMutex.lock();
+        samplingChange = NIDAQmxSamplingConfig(command.get(1).asInt(), command.get(2).asDouble(), DAQTaskConfig.DAQSamplingTimeout,
+                command.size() > 3 ? command.get(3).asInt() : DAQTaskConfig.DAQSamplingBufferSize);
+        samplingChangeResult.store(false, std::memory_order_relaxed);
+        samplingChangePending.store(true, std::memory_order_release);
+        samplingChangeDone.wait();
+        bool result = samplingChangeResult.load(std::memory_order_relaxed);
+        samplingChangeMutex.unlock();
+
+        reply.addString(result ? "ok" : "failed");
+    } else if (cmd == "getOutputs") {
+        // One list per port
+        const char *policyNames[] = {"strict", "dropOldest", "latest"};
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            Bottle &outputInfo = reply.addList();
+            outputInfo.addString(outputs[i]->getName().c_str());
+            outputInfo.addString(policyNames[outputs[i]->getPolicy()]);
+            outputInfo.addInt((int) outputs[i]->getDepth());
+            outputInfo.addInt((int) outputs[i]->getQueued());
+            outputInfo.addInt((int) outputs[i]->getDropped());
+        }
+    } else if (cmd == "subscribe") {
+        // Readers of a multicast port share its single send
+        if ((command.size() == 3) && connectMulticast(command.get(1).asString().c_str(), command.get(2).asString().c_str())) {
+            reply.addString("ok");
+        } else {
+            reply.addString("failed");
+        }
+    } else if (cmd == "getMetrics") {
+        // One (name value) list per metric, named as on the HTTP endpoint
+        vector<std::pair<string, double> > values;
+        metrics.collect(outputs, values);
+        for (size_t i = 0; i < values.size(); ++i) {
+            Bottle &metric = reply.addList();
+            metric.addString(values[i].first.c_str());
+            metric.addDouble(values[i].second);
+        }
+    } else if (cmd == "getAvailability") {
+        // Include the ongoing gap, if any
+        recoveryMutex.lock();
+        double now = monotonicNow();
+        double downtime = totalDowntime + (DAQTaskLost ? now - gapStart : 0);
+        double elapsed = now - startTime;
+        reply.addInt(nRecoveries);
+        reply.addDouble(lastGap);
+        reply.addDouble(downtime);
+        reply.addDouble(elapsed > 0 ? 1 - downtime / elapsed : 1);
+        recoveryMutex.unlock();
+    } else {
+        return RFModule::respond(command, reply);
+    }
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Apply a sampling reconfiguration.                                ********************************************** */
+void NIDAQmxReaderModule::applySamplingChange(void) {
+    // Let the blocks read at the old rate go through the current stages
+    if (DAQStrand) {
+        DAQStrand->drain();
+    }
+
+    NIDAQmxLog::log(NIDAQmxLog::Info, "%sReconfiguring sampling to %d samples per channel at %g Hz.", dbgTag.c_str(),
+            samplingChange.getDAQSamplesPerChannel(), samplingChange.getDAQSamplingRate());
+
+    bool result = DAQTask->setSamplingConfig(samplingChange);
+    if (result) {
+        DAQTaskConfig.DAQSamplesPerChannel = samplingChange.getDAQSamplesPerChannel();
+        DAQTaskConfig.DAQSamplingRate = samplingChange.getDAQSamplingRate();
+        DAQTaskConfig.DAQSamplingBufferSize = samplingChange.getDAQSamplingBufferSize();
+
+        // The stage windows are expressed in scans
+        deleteStages();
+        createStages();
+    }
+
+    // The rpc call may have been released by interruptModule() already
+    samplingChangeResult.store(result, std::memory_order_relaxed);
+    if (samplingChangePending.exchange(false, std::memory_order_acq_rel)) {
+        samplingChangeDone.post();
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Handle a failed read.                                            ********************************************** */
+bool NIDAQmxReaderModule::handleReadFailure(void) {
+    NIDAQmxErrorClass errorClass = DAQTask->classifyLastError();
+    int errorCode = DAQTask->getLastError();
+    metrics.addDriverError(errorClass == ErrorOverrun);
+
+    // A late block is retried before giving up on the task
+    if ((errorClass == ErrorTransient) && (++transientErrors < recoveryTimeouts)) {
+        NIDAQmxLog::log(NIDAQmxLog::Warning, "%sWarning: Read timed out (error %d), retrying.", dbgTag.c_str(), errorCode);
+        return true;
+    }
+    transientErrors = 0;
+
+    recoveryMutex.lock();
+    DAQTaskLost = true;
+    gapStart = monotonicNow();
+    gapError = errorCode;
+    recoveryMutex.unlock();
+
+    NIDAQmxLog::log(NIDAQmxLog::Error, "%sError: Could not run the DAQ Task (error %d), restarting it.", dbgTag.c_str(), errorCode);
+
+    return recoverTask();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Recover the DAQ task.                                            ********************************************** */
+bool NIDAQmxReaderModule::recoverTask(void) {
+    // The blocks read before the failure are published before the gap
+    if (DAQStrand) {
+        DAQStrand->drain();
+    }
+
+    if (!DAQTask->recoverDAQTask(recoveryBudget)) {
+        unsigned int suppressed;
+        if (recoveryLogLimiter.allow(suppressed)) {
+            NIDAQmxLog::log(NIDAQmxLog::Error, "%sError: The DAQ Task could not be recovered, trying again.", dbgTag.c_str());
+        }
+
+        return false;
+    }
+
+    recoveryMutex.lock();
+    double gap = monotonicNow() - gapStart;
+    DAQTaskLost = false;
+    ++nRecoveries;
+    lastGap = gap;
+    totalDowntime += gap;
+    recoveryMutex.unlock();
+    metrics.addRecovery();
+
+    NIDAQmxLog::log(NIDAQmxLog::Warning, "%sWarning: DAQ Task recovered after a %g s gap (%d recoveries, %g s in total).", dbgTag.c_str(),
+            gap, nRecoveries, totalDowntime);
+
+    // The stages must not mix the scans from both sides of the gap
+    DAQStagesFed.assign(DAQStages.size(), false);
+    analogPreviewFed = false;
+
+    publishGap(gap);
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Process a block.                                                 ********************************************** */
+void NIDAQmxReaderModule::processResults(nidaqmx::NIDAQmxResults &io_results, const double &i_readTime) {
+    using std::vector;
+    using yarp::sig::Vector;
+
+    // Only compute and write the outputs somebody is reading
+    bool publishAnalog = (portNIDAQmxReaderOutAnalog.getOutputCount() > 0);
+    bool publishReal = (portNIDAQmxReaderOutReal.getOutputCount() > 0);
+    bool publishAnalogBlock = (portNIDAQmxReaderOutAnalogBlock.getOutputCount() > 0);
+    bool publishRealBlock = (portNIDAQmxReaderOutRealBlock.getOutputCount() > 0);
+    bool publishRealQuantised = (portNIDAQmxReaderOutRealQuantised.getOutputCount() > 0);
+    bool needReal = publishReal || publishRealBlock || publishRealQuantised;
+    for (size_t i = 0; i < DAQStages.size(); ++i) {
+        bool feed = (DAQStagePorts[i]->getOutputCount() > 0);
+        if (feed && !DAQStagesFed[i]) {    // The stage missed some blocks
+            DAQStages[i]->reset();
+        }
+        DAQStagesFed[i] = feed;
+        needReal = needReal || feed;
+    }
+
+    // A calibration set over rpc is swapped in even if this block is not calibrated, together with the matching quantiser ranges
+    if (quantiserPending.load(std::memory_order_acquire)) {
+        quantiserMutex.lock();
+        DAQTask->applyPendingCalibration();
+        realQuantiser->setRanges(quantiserMin, quantiserMax);
+        quantiserPending.store(false, std::memory_order_relaxed);
+        quantiserMutex.unlock();
+    }
+
+    // The calibration is skipped when nobody needs the real values
+    NIDAQmxMetrics::BlockTimes blockTimes;
+    uint64_t phaseStart = monotonicNanoseconds();
+    if (needReal && !DAQTask->calibrateResults(io_results)) {
+        NIDAQmxLog::log(NIDAQmxLog::Error, "%sError: Could not calibrate the block.", dbgTag.c_str());
+        return;
+    }
+    phaseStart = blockTimes.add(NIDAQmxMetrics::PhaseCalibrate, phaseStart);
+
+    // Output data on port
+    int nChannels = DAQTaskConfig.DAQChannels.size();
+    int nOutputs = DAQNOutputs;
+    int nCounters = DAQTaskConfig.DAQCounterChannels.size();
+    int samplesPerChannel = DAQTaskConfig.DAQSamplesPerChannel;
+    int totSamples = nChannels * samplesPerChannel;
+    size_t nScans = io_results.analogValues.size() / nChannels;
+    lastScan = io_results.firstScan + nScans - 1;
+
+    // Timed from the reading of the last scan, the block may have waited on the strand since
+    double dt = 1.0 / DAQTaskConfig.DAQSamplingRate;
+    double t0 = i_readTime - (nScans - 1) * dt;
+
+    //for (size_t i = 0; i < samplesPerChannel; ++i) {
+    for (size_t i = 0; (publishAnalog || publishReal) && (i < nScans); ++i) {
+        // Store timestamp
+        portStamp.update(t0 + i * dt);
+        unsigned int discontinuity = (i == 0) ? io_results.discontinuity : 0;
+
+        if (publishAnalog) {
+            Vector &outAnalog = portNIDAQmxReaderOutAnalog.prepare();
+            outAnalog.clear();
+            for (int j = 0; j < nChannels; ++j) {
+                outAnalog.push_back(io_results.analogValues[nChannels*i+j]);
+            }
+
+            setPortEnvelope(portNIDAQmxReaderOutAnalog, io_results.firstScan + i, discontinuity);
+            portNIDAQmxReaderOutAnalog.write();
+        }
+
+        if (publishReal) {
+            Vector &outReal = portNIDAQmxReaderOutReal.prepare();
+            outReal.clear();
+            for (int j = 0; j < nOutputs; ++j) {
+                outReal.push_back(io_results.realValues[nOutputs*i+j]);
+            }
+            // Counters latched with this scan follow the sensor values
+            for (int j = 0; j < nCounters; ++j) {
+                outReal.push_back(io_results.counterValues[nCounters*i+j]);
+            }
+
+            setPortEnvelope(portNIDAQmxReaderOutReal, io_results.firstScan + i, discontinuity);
+            portNIDAQmxReaderOutReal.write();
+        }
+    }
+
+    // Whole blocks, one message each, and the stages are stamped with the reading of the last scan
+    portStamp.update(i_readTime);
+    if (publishAnalogBlock) {
+        NIDAQmxBlockMessage &outAnalogBlock = portNIDAQmxReaderOutAnalogBlock.prepare();
+        outAnalogBlock.setTiming(io_results.firstScan, t0, dt, io_results.discontinuity);
+        outAnalogBlock.setFloat64(&io_results.analogValues[0], nScans, nChannels);
+
+        setPortEnvelope(portNIDAQmxReaderOutAnalogBlock, io_results.firstScan, io_results.discontinuity);
+        portNIDAQmxReaderOutAnalogBlock.write();
+    }
+
+    if (publishRealBlock) {
+        NIDAQmxBlockMessage &outRealBlock = portNIDAQmxReaderOutRealBlock.prepare();
+        outRealBlock.setTiming(io_results.firstScan, t0, dt, io_results.discontinuity);
+        if (nCounters == 0) {
+            outRealBlock.setFloat64(&io_results.realValues[0], nScans, nOutputs);
+        } else {    // Counters latched with each scan follow the sensor values, as on real:o
+            double *values = outRealBlock.resizeFloat64(nScans, nOutputs + nCounters);
+            for (size_t i = 0; i < nScans; ++i) {
+                values = std::copy(io_results.realValues.begin() + nOutputs*i, io_results.realValues.begin() + nOutputs*(i+1), values);
+                values = std::copy(io_results.counterValues.begin() + nCounters*i, io_results.counterValues.begin() + nCounters*(i+1), values);
+            }
+        }
+
+        setPortEnvelope(portNIDAQmxReaderOutRealBlock, io_results.firstScan, io_results.discontinuity);
+        portNIDAQmxReaderOutRealBlock.write();
+    }
+
+    if (publishRealQuantised) {
+        NIDAQmxBlockMessage &outRealQuantised = portNIDAQmxReaderOutRealQuantised.prepare();
+        outRealQuantised.setTiming(io_results.firstScan, t0, dt, io_results.discontinuity);
+        const double *scales = &realQuantiser->getScales()[0];
+        const double *offsets = &realQuantiser->getOffsets()[0];
+        if (deltaCompression) {
+            quantisedValues.resize(io_results.realValues.size());
+            realQuantiser->quantise(io_results.realValues, &quantisedValues[0]);
+            outRealQuantised.packInt16(&quantisedValues[0], nScans, nOutputs, scales, offsets);
+        } else {    // Quantised straight into the message
+            realQuantiser->quantise(io_results.realValues, outRealQuantised.resizeInt16(nScans, nOutputs, scales, offsets));
+        }
+
+        setPortEnvelope(portNIDAQmxReaderOutRealQuantised, io_results.firstScan, io_results.discontinuity);
+        portNIDAQmxReaderOutRealQuantised.write();
+    }
+
+    // Report saturated blocks only
+    if ((io_results.saturatedScans > 0) && (portNIDAQmxReaderOutSaturation.getOutputCount() > 0)) {
+        Vector &outSaturation = portNIDAQmxReaderOutSaturation.prepare();
+        outSaturation.clear();
+        for (int j = 0; j < nChannels; ++j) {
+            outSaturation.push_back(io_results.saturationCounts[j]);
+        }
+        outSaturation.push_back(io_results.saturatedScans);
+
+        // Then the position in the block and the channel mask of each affected scan
+        for (size_t s = 0; s < io_results.saturationFlags.size(); ++s) {
+            if (io_results.saturationFlags[s] != 0) {
+                outSaturation.push_back(s);
+                outSaturation.push_back(io_results.saturationFlags[s]);
+            }
+        }
+
+        setPortEnvelope(portNIDAQmxReaderOutSaturation, io_results.firstScan, io_results.discontinuity);
+        portNIDAQmxReaderOutSaturation.write();
+    }
+
+    phaseStart = blockTimes.add(NIDAQmxMetrics::PhasePublish, phaseStart);
+
+    // Feed the processing stages with the whole block
+    for (size_t i = 0; i < DAQStages.size(); ++i) {
+        if (DAQStagesFed[i]) {
+            DAQStages[i]->processBlock(io_results.realValues);
+            phaseStart = blockTimes.add(DAQStagePhases[i], phaseStart);
+        }
+    }
+    publishEvent();
+    publishStatistics();
+    publishSpectrum();
+    phaseStart = blockTimes.add(NIDAQmxMetrics::PhasePublish, phaseStart);
+
+    // The analog envelope is computed from the raw values
+    if (analogPreview) {
+        bool feed = (portNIDAQmxReaderOutAnalogPreview.getOutputCount() > 0);
+        if (feed && !analogPreviewFed) {
+            analogPreview->reset();
+        }
+        analogPreviewFed = feed;
+        if (feed) {
+            analogPreview->processBlock(io_results.analogValues);
+        }
+    }
+    // The first bin after lost scans carries their flags, even when it completes in a later block
+    analogPreviewDiscontinuity |= io_results.discontinuity;
+    realPreviewDiscontinuity |= io_results.discontinuity;
+    publishPreview(analogPreview, portNIDAQmxReaderOutAnalogPreview, analogPreviewDiscontinuity);
+    publishPreview(realPreview, portNIDAQmxReaderOutRealPreview, realPreviewDiscontinuity);
+    blockTimes.add(NIDAQmxMetrics::PhasePreview, phaseStart);
+
+    metrics.addBlockPublished(blockTimes);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Block job constructor.                                           ********************************************** */
+NIDAQmxReaderModule::BlockJob::BlockJob(NIDAQmxReaderModule *aModule) : readTime(0), module(aModule) {
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Process a block on the strand.                                   ********************************************** */
+void NIDAQmxReaderModule::BlockJob::run(void) {
+    module->processResults(results, readTime);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Return a block job to the free ones.                             ********************************************** */
+void NIDAQmxReaderModule::BlockJob::release(void) {
+    module->blockJobsMutex.lock();
+    module->freeBlockJobs.push_back(this);
+    module->blockJobsMutex.unlock();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Create the processing stages.                                    ********************************************** */
+void NIDAQmxReaderModule::createStages(void) {
+    if (!eventThresholds.empty()) {
+        size_t preScans = (size_t) (eventPreTrigger * DAQTaskConfig.DAQSamplingRate);
+        size_t postScans = (size_t) (eventPostTrigger * DAQTaskConfig.DAQSamplingRate);
+
+        eventRecorder = new NIDAQmxEventRecorder(DAQNOutputs, preScans, postScans, eventThresholds);
+        DAQStages.push_back(eventRecorder);
+        DAQStagePorts.push_back(&portNIDAQmxReaderOutEvent);
+        DAQStagePhases.push_back(NIDAQmxMetrics::PhaseEvent);
+    }
+
+    if (statisticsWindow > 0) {
+        size_t windowScans = (size_t) (statisticsWindow * DAQTaskConfig.DAQSamplingRate);
+
+        windowStatistics = new NIDAQmxWindowStatistics(DAQNOutputs, windowScans);
+        DAQStages.push_back(windowStatistics);
+        DAQStagePorts.push_back(&portNIDAQmxReaderOutStats);
+        DAQStagePhases.push_back(NIDAQmxMetrics::PhaseStatistics);
+    }
+
+    if (spectrumFFTSize > 0) {
+        spectrum = new NIDAQmxSpectrum(DAQNOutputs, spectrumFFTSize, spectrumAverages, DAQTaskConfig.DAQSamplingRate, spectrumBands);
+        DAQStages.push_back(spectrum);
+        DAQStagePorts.push_back(&portNIDAQmxReaderOutSpectrum);
+        DAQStagePhases.push_back(NIDAQmxMetrics::PhaseSpectrum);
+    }
+
+    if (previewRate > 0) {
+        size_t binScans = (size_t) (DAQTaskConfig.DAQSamplingRate / previewRate);
+
+        realPreview = new NIDAQmxEnvelope(DAQNOutputs, binScans);
+        DAQStages.push_back(realPreview);
+        DAQStagePorts.push_back(&portNIDAQmxReaderOutRealPreview);
+        DAQStagePhases.push_back(NIDAQmxMetrics::PhasePreview);
+
+        analogPreview = new NIDAQmxEnvelope(DAQTaskConfig.DAQChannels.size(), binScans);
+        analogPreviewFed = false;
+    }
+
+    // Stages start as skipped, so they are reset when first fed
+    DAQStagesFed.assign(DAQStages.size(), false);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Delete the processing stages.                                    ********************************************** */
+void NIDAQmxReaderModule::deleteStages(void) {
+    for (size_t i = 0; i < DAQStages.size(); ++i) {
+        delete DAQStages[i];
+    }
+    DAQStages.clear();
+    DAQStagePorts.clear();
+    DAQStagePhases.clear();
+    eventRecorder = NULL;
+    windowStatistics = NULL;
+    spectrum = NULL;
+    realPreview = NULL;
+
+    if (analogPreview) {
+        delete analogPreview;
+        analogPreview = NULL;
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Publish an event snapshot.                                       ********************************************** */
+void NIDAQmxReaderModule::publishEvent(void) {
+    using yarp::sig::Matrix;
+
+    size_t preScans;
+    size_t triggerChannel;
+    if (!eventRecorder || !eventRecorder->popSnapshot(eventScans, preScans, triggerChannel)) {
+        return;
+    }
+
+    size_t nChannels = DAQNOutputs;
+    size_t nScans = eventScans.size() / nChannels;
+    NIDAQmxLog::log(NIDAQmxLog::Info, "%sEvent on output %d: %d scans captured (%d before the crossing).", dbgTag.c_str(),
+            (int) triggerChannel, (int) nScans, (int) preScans);
+
+    // One row per scan
+    Matrix &outEvent = portNIDAQmxReaderOutEvent.prepare();
+    outEvent.resize(nScans, nChannels);
+    for (size_t i = 0; i < nScans; ++i) {
+        for (size_t j = 0; j < nChannels; ++j) {
+            outEvent[i][j] = eventScans[i*nChannels + j];
+        }
+    }
+
+    // The timestamp is the one of the last scan in the snapshot
+    setPortEnvelope(portNIDAQmxReaderOutEvent, lastScan, 0);
+    portNIDAQmxReaderOutEvent.write();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Publish the window statistics.                                   ********************************************** */
+void NIDAQmxReaderModule::publishStatistics(void) {
+    using yarp::sig::Vector;
+
+    if (!windowStatistics || !windowStatistics->popStatistics(statistics)) {
+        return;
+    }
+
+    // Grouped by statistic, one value per channel
+    const std::vector<double> *fields[] = {&statistics.min, &statistics.max, &statistics.mean, &statistics.rms, &statistics.variance};
+    Vector &outStats = portNIDAQmxReaderOutStats.prepare();
+    outStats.clear();
+    for (size_t f = 0; f < 5; ++f) {
+        for (size_t j = 0; j < fields[f]->size(); ++j) {
+            outStats.push_back((*fields[f])[j]);
+        }
+    }
+
+    setPortEnvelope(portNIDAQmxReaderOutStats, lastScan, 0);
+    portNIDAQmxReaderOutStats.write();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Publish the spectrum band energies.                              ********************************************** */
+void NIDAQmxReaderModule::publishSpectrum(void) {
+    using yarp::sig::Vector;
+
+    if (!spectrum || !spectrum->popBandEnergies(bandEnergies)) {
+        return;
+    }
+
+    Vector &outSpectrum = portNIDAQmxReaderOutSpectrum.prepare();
+    outSpectrum.clear();
+    for (size_t i = 0; i < bandEnergies.size(); ++i) {
+        outSpectrum.push_back(bandEnergies[i]);
+    }
+
+    setPortEnvelope(portNIDAQmxReaderOutSpectrum, lastScan, 0);
+    portNIDAQmxReaderOutSpectrum.write();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Publish the preview envelopes.                                   ********************************************** */
+void NIDAQmxReaderModule::publishPreview(NIDAQmxEnvelope *i_envelope, NIDAQmxOutputQueue<yarp::sig::Vector> &i_port, unsigned int &io_discontinuity) {
+    using yarp::sig::Vector;
+
+    if (!i_envelope || !i_envelope->popEnvelopes(previewEnvelopes)) {
+        return;
+    }
+
+    // A block may span several bins, write them all
+    size_t binSize = (i_envelope == analogPreview) ? 2 * DAQTaskConfig.DAQChannels.size() : 2 * DAQNOutputs;
+    size_t nBins = previewEnvelopes.size() / binSize;
+
+    // The bins were completed by the last block, the last one ending before the scans of the current bin
+    uInt64 binLastScan = lastScan - i_envelope->getBinFill() - (nBins - 1) * i_envelope->getBinScans();
+    for (size_t b = 0; b < nBins; ++b) {
+        Vector &outPreview = i_port.prepare();
+        outPreview.clear();
+        for (size_t i = 0; i < binSize; ++i) {
+            outPreview.push_back(previewEnvelopes[b * binSize + i]);
+        }
+
+        setPortEnvelope(i_port, binLastScan, io_discontinuity);
+        i_port.write();
+
+        io_discontinuity = 0;
+        binLastScan += i_envelope->getBinScans();
+    }
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Find an output port from its key.                                ********************************************** */
+NIDAQmxOutput *NIDAQmxReaderModule::findOutput(const std::string &i_key) {
+    std::string name = "/NIDAQmxReader/data/" + i_key + ":o";
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        if (outputs[i]->getName() == name) {
+            return outputs[i];
+        }
+    }
+
+    return NULL;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Connect a multicast reader.                                      ********************************************** */
+bool NIDAQmxReaderModule::connectMulticast(const std::string &i_key, const std::string &i_reader) {
+    if (std::find(multicastOutputs.begin(), multicastOutputs.end(), i_key) == multicastOutputs.end()) {
+        return false;
+    }
+
+    // The first mcast connection creates the group, the next ones join it
+    return yarp::os::Network::connect(findOutput(i_key)->getName().c_str(), i_reader.c_str(), "mcast");
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Open an output port.                                             ********************************************** */
+template <class T>
+bool NIDAQmxReaderModule::openOutput(NIDAQmxOutputQueue<T> &io_port, const std::string &i_name, const Bottle &i_conf, const std::string &i_key,
+        const NIDAQmxOutputPolicy &i_policy, const size_t &i_depth) {
+    using std::string;
+
+    NIDAQmxOutputPolicy policy = i_policy;
+    int depth = i_depth;
+
+    // The policy name, followed by the depth unless it is latest
+    Bottle *policyList = i_conf.find(i_key.c_str()).asList();
+    if (policyList && (policyList->size() > 0)) {
+        string policyName = policyList->get(0).asString().c_str();
+        if (policyName == "strict") {
+            policy = OutputStrict;
+        } else if (policyName == "dropOldest") {
+            policy = OutputDropOldest;
+        } else if (policyName == "latest") {
+            policy = OutputLatest;
+        } else {
+            return false;
+        }
+
+        if (policyList->size() > 1) {
+            depth = policyList->get(1).asInt();
+        }
+        if (depth < 1) {
+            return false;
+        }
+    }
+
+    if (!io_port.open(i_name, policy, depth)) {
+        return false;
+    }
+    outputs.push_back(&io_port);
+
+    return true;
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Set the envelope of a port.                                      ********************************************** */
+void NIDAQmxReaderModule::setPortEnvelope(NIDAQmxOutput &io_port, const uInt64 &i_scan, const unsigned int &i_discontinuity) {
+    // The stamp count is the scan index, wrapped to the range of a yarp::os::Stamp count
+    if (std::find(scanEnvelopeOutputs.begin(), scanEnvelopeOutputs.end(), &io_port) == scanEnvelopeOutputs.end()) {
+        io_port.setEnvelope(yarp::os::Stamp((int) (i_scan & 0x7fffffff), portStamp.getTime()));
+        return;
+    }
+
+    // The stamp fields come first, followed by the scan index and discontinuity flags
+    scanStamp.clear();
+    scanStamp.addInt((int) (i_scan & 0x7fffffff));
+    scanStamp.addDouble(portStamp.getTime());
+    scanStamp.addDouble((double) i_scan);
+    scanStamp.addInt(i_discontinuity);
+    io_port.setEnvelope(scanStamp);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Publish a gap marker.                                            ********************************************** */
+void NIDAQmxReaderModule::publishGap(const double &i_duration) {
+    using yarp::sig::Vector;
+
+    Vector &outGap = portNIDAQmxReaderOutGap.prepare();
+    outGap.clear();
+    outGap.push_back(gapError);
+    outGap.push_back(i_duration);
+    outGap.push_back(nRecoveries);
+    outGap.push_back(totalDowntime);
+    outGap.push_back((double) DAQTask->getScanIndex());
+    outGap.push_back(DiscontinuityRecovery);
+
+    // The timestamp is the one of the recovery
+    portStamp.update();
+    setPortEnvelope(portNIDAQmxReaderOutGap, DAQTask->getScanIndex(), DiscontinuityRecovery);
+    portNIDAQmxReaderOutGap.write();
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Parse a calibration from configuration lists.                    ********************************************** */
+bool NIDAQmxReaderModule::parseCalibration(const Bottle &i_scales, const Bottle &i_matrix, const size_t &i_nChannels,
+        std::vector<double> &o_scales, nidaqmx::DoubleMatrix2D &o_matrix) {
+    using std::vector;
+
+    // One scale per matrix row, each row holding one coefficient per channel
+    size_t nOutputs = i_scales.size();
+    if ((i_nChannels == 0) || (nOutputs == 0) || (i_matrix.size() != (int) (nOutputs * i_nChannels))) {
+        return false;
+    }
+
+    // Initialise vectors
+    o_scales = vector<double>(nOutputs);
+    o_matrix = DoubleMatrix2D(nOutputs, vector<double>(i_nChannels));
+
+    // Fill vectors from the lists
+    for (size_t i = 0; i < nOutputs; ++i) {         // Matrix rows
+        o_scales[i] = i_scales.get(i).asDouble();
+        for (size_t j = 0; j < i_nChannels; ++j) {  // Matrix cols
+            o_matrix[i][j] = i_matrix.get((i*i_nChannels)+j).asDouble();
+        }
+    }
 
     return true;
 }
 /* *********************************************************************************************************************** */
 
 
+/* *********************************************************************************************************************** */
+/* ******* Compute the ranges of the real values.                           ********************************************** */
+void NIDAQmxReaderModule::computeQuantiserRanges(const std::vector<double> &i_scales, const nidaqmx::DoubleMatrix2D &i_matrix,
+        std::vector<double> &o_min, std::vector<double> &o_max) {
+    // The bias and output transform are part of the composed affine map y = A x + b applied to the analog values
+    NIDAQmxCalibrationConfig calibration(i_scales, i_matrix, DAQTaskConfig.DAQSensorBias, DAQTaskConfig.DAQOutputTransform);
+    NIDAQmxQuantiser::affineRanges(calibration.getDAQAffineMatrix(), calibration.getDAQAffineOffset(),
+            DAQTaskConfig.DAQMinVals, DAQTaskConfig.DAQMaxVals, o_min, o_max);
+}
+/* *********************************************************************************************************************** */
+
+
+/* *********************************************************************************************************************** */
+/* ******* Replicate the sensor on the simulated device.                    ********************************************** */
+void NIDAQmxReaderModule::replicateSensor(const size_t &i_copies) {
+    size_t nChannels = DAQTaskConfig.DAQChannels.size();
+
+    // Each copy gets its own channels and outputs, calibrated like the original ones
+    repeatValues(DAQTaskConfig.DAQChannels, i_copies);
+    repeatValues(DAQTaskConfig.DAQChannelTypes, i_copies);
+    repeatValues(DAQTaskConfig.DAQTerminalConfig, i_copies);
+    repeatValues(DAQTaskConfig.DAQMinVals, i_copies);
+    repeatValues(DAQTaskConfig.DAQMaxVals, i_copies);
+    repeatValues(DAQTaskConfig.DAQSensorCalibScales, i_copies);
+    repeatValues(DAQTaskConfig.DAQSensorBias, i_copies);
+    repeatValues(eventThresholds, i_copies);
+    DAQTaskConfig.DAQSensorCalibMatrix = repeatDiagonal(DAQTaskConfig.DAQSensorCalibMatrix, nChannels, i_copies);
+    if (!DAQTaskConfig.DAQOutputTransform.empty()) {
+        DAQTaskConfig.DAQOutputTransform = repeatDiagonal(DAQTaskConfig.DAQOutputTransform, DAQNOutputs, i_copies);
+    }
+    DAQNOutputs *= i_copies;
+
+    std::cout << moduleName << ": Simulating " << i_copies << " sensors, " << DAQTaskConfig.DAQChannels.size() << " channels and "
+        << DAQNOutputs << " outputs. \n";
+}
+/* *********************************************************************************************************************** */
+
+
 /* *********************************************************************************************************************** */
 /* ******* Delete allocated memory.                                         ********************************************** */
 void NIDAQmxReaderModule::freeMemory(void) {
+    // Deleting the strand waits for the blocks still queued
+    if (DAQStrand) {
+        delete DAQStrand;
+        DAQStrand = NULL;
+    }
+    for (size_t i = 0; i < blockJobs.size(); ++i) {
+        delete blockJobs[i];
+    }
+    blockJobs.clear();
+    freeBlockJobs.clear();
+
+    deleteStages();
+
+    if (realQuantiser) {
+        delete realQuantiser;
+        realQuantiser = NULL;
+    }
+
     if (DAQTask) {
         delete DAQTask;
     }
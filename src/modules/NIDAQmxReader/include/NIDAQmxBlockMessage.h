@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+
+
+#ifndef __NIDAQMXBLOCKMESSAGE_H__
+#define __NIDAQMXBLOCKMESSAGE_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/os/Portable.h>
+
+#include <NIDAQmxTask/include/NIDAQmxDeltaCodec.h>
+
+
+/**
+ * The types of the values of a block message.
+ */
+enum NIDAQmxBlockType {
+    BlockFloat64 = 0,       // 64-bit floating point values
+    BlockInt16 = 1,         // 16-bit quantised values, preceded by the scale and offset of each channel
+    BlockInt16Delta = 2     // 16-bit quantised values packed by the NIDAQmxDeltaCodec, preceded by the scale and offset of each channel
+};
+
+
+/**
+ * The fixed header of a block message.
+ * All the fields are little-endian, the byte order of the platforms the module runs on.
+ */
+struct NIDAQmxBlockHeader {
+    /**
+     * The index of the first scan of the block, counted since the DAQ task was created.
+     */
+    uint64_t firstScan;
+
+    /**
+     * The time of the first scan in seconds, estimated from the time the block was read.
+     */
+    double t0;
+
+    /**
+     * The time between two scans in seconds.
+     */
+    double dt;
+
+    /**
+     * The format version, NIDAQmxBlockMessage::version.
+     */
+    uint32_t version;
+
+    /**
+     * The number of values per scan.
+     */
+    uint32_t nChannels;
+
+    /**
+     * The number of scans in the block.
+     */
+    uint32_t nScans;
+
+    /**
+     * The NIDAQmxBlockType of the values.
+     */
+    uint32_t type;
+
+    /**
+     * The NIDAQmxDiscontinuity flags of the scans missing before the block.
+     */
+    uint32_t flags;
+
+    /**
+     * The size in bytes of the packed values of a BlockInt16Delta block, 0 for the other types.
+     * It also keeps the header size a multiple of 8 bytes.
+     */
+    uint32_t packedSize;
+};
+
+
+/**
+ * \class NIDAQmxBlockMessage
+ *
+ * \brief The NIDAQmxBlockMessage is the message carrying a whole block of scans on a single port write.
+ *
+ *
+ * \section intro_sec Description
+ * A block message is made of a NIDAQmxBlockHeader followed by the values of the block, scan after scan,
+ * each scan holding one value per channel.
+ * Both are sent as raw blocks of bytes, so that writing a message copies its values once and reading it needs no per-value parsing:
+ * the values can be used in place through getFloat64().
+ *
+ * Compared to a yarp::sig::Vector per scan, this saves the per-message overhead of the port, which dominates at high sampling rates.
+ *
+ * A BlockInt16 payload starts with the scale and then the offset of each channel, as 64-bit floating point values,
+ * followed by the quantised values. Value j of a scan is recovered as offset[j] + scale[j] * q.
+ * A BlockInt16Delta payload holds the same values losslessly packed by the nidaqmx::NIDAQmxDeltaCodec, usually several times smaller;
+ * unpackInt16() reads both.
+ *
+ *
+ * \author NIDAQmx contributors
+ *
+ * \copyright
+ *
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ *
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/modules/include/NIDAQmxBlockMessage.h.
+ */
+class NIDAQmxBlockMessage : public yarp::os::Portable {
+    private:
+        /**
+         * The message header.
+         */
+        NIDAQmxBlockHeader header;
+
+        /**
+         * The values, as raw bytes.
+         */
+        std::vector<char> payload;
+
+    public:
+        /**
+         * The format version written by this class.
+         */
+        static const uint32_t version = 1;
+
+        /**
+         * Default constructor, building an empty block.
+         */
+        NIDAQmxBlockMessage();
+
+        /**
+         * Get the message header.
+         */
+        NIDAQmxBlockHeader &getHeader(void);
+        const NIDAQmxBlockHeader &getHeader(void) const;
+
+        /**
+         * Set the header fields describing the timing of the block.
+         * \param i_firstScan The index of the first scan
+         * \param i_t0 The time of the first scan in seconds
+         * \param i_dt The time between two scans in seconds
+         * \param i_flags The NIDAQmxDiscontinuity flags
+         */
+        void setTiming(const uint64_t &i_firstScan, const double &i_t0, const double &i_dt, const uint32_t &i_flags);
+
+        /**
+         * Size the block for 64-bit floating point values.
+         * \param i_nScans The number of scans
+         * \param i_nChannels The number of values per scan
+         * \returns The values to be filled, scan after scan
+         */
+        double *resizeFloat64(const uint32_t &i_nScans, const uint32_t &i_nChannels);
+
+        /**
+         * Copy 64-bit floating point values into the block.
+         * \param i_values The values, scan after scan
+         * \param i_nScans The number of scans
+         * \param i_nChannels The number of values per scan
+         */
+        void setFloat64(const double *i_values, const uint32_t &i_nScans, const uint32_t &i_nChannels);
+
+        /**
+         * Get the values of a 64-bit floating point block in place.
+         * \returns The values, scan after scan, or NULL if the block holds values of another type
+         */
+        const double *getFloat64(void) const;
+
+        /**
+         * Size the block for 16-bit quantised values and set the quantisation of each channel.
+         * \param i_nScans The number of scans
+         * \param i_nChannels The number of values per scan
+         * \param i_scales The value of one quantisation step of each channel
+         * \param i_offsets The value of each channel sent as zero
+         * \returns The quantised values to be filled, scan after scan
+         */
+        int16_t *resizeInt16(const uint32_t &i_nScans, const uint32_t &i_nChannels, const double *i_scales, const double *i_offsets);
+
+        /**
+         * Get the values of a 16-bit quantised block in place.
+         * \returns The quantised values, scan after scan, or NULL if the block holds values of another type
+         */
+        const int16_t *getInt16(void) const;
+
+        /**
+         * Pack 16-bit quantised values into the block, with the quantisation of each channel.
+         * \param i_values The quantised values, scan after scan
+         * \param i_nScans The number of scans
+         * \param i_nChannels The number of values per scan
+         * \param i_scales The value of one quantisation step of each channel
+         * \param i_offsets The value of each channel sent as zero
+         */
+        void packInt16(const int16_t *i_values, const uint32_t &i_nScans, const uint32_t &i_nChannels, const double *i_scales, const double *i_offsets);
+
+        /**
+         * Get a copy of the values of a 16-bit quantised block, packed or not.
+         * \param o_values The quantised values, scan after scan
+         * \returns false if the block holds values of another type or cannot be unpacked
+         */
+        bool unpackInt16(std::vector<int16_t> &o_values) const;
+
+        /**
+         * Get the quantisation scales of a 16-bit quantised block, one per channel.
+         * \returns The scales, or NULL if the block holds values of another type
+         */
+        const double *getInt16Scales(void) const;
+
+        /**
+         * Get the quantisation offsets of a 16-bit quantised block, one per channel.
+         * \returns The offsets, or NULL if the block holds values of another type
+         */
+        const double *getInt16Offsets(void) const;
+
+        /**
+         * Get the size of the message, header included.
+         */
+        size_t getSize(void) const;
+
+        virtual bool write(yarp::os::ConnectionWriter &connection);
+        virtual bool read(yarp::os::ConnectionReader &connection);
+};
+
+
+/**
+ * The size of a block message, counted by the output queues.
+ */
+inline size_t NIDAQmxMessageSize(const NIDAQmxBlockMessage &i_message) {
+    return i_message.getSize();
+}
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+
+
+#ifndef __NIDAQMXMETRICS_H__
+#define __NIDAQMXMETRICS_H__
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "NIDAQmxOutputQueue.h"
+
+
+/**
+ * \class NIDAQmxMetrics
+ *
+ * \brief The NIDAQmxMetrics counts the work done by the module, to be scraped by the lab monitoring.
+ *
+ *
+ * \section intro_sec Description
+ * The counters are updated by the reading and processing threads with relaxed atomic operations only,
+ * so that they cost a few instructions per block and never make the acquisition wait for a reader of the metrics.
+ * Each counter is consistent on its own, but counters read together may come from slightly different blocks.
+ *
+ * The time spent in each phase of the processing of a block is measured with a monotonic clock on the thread doing it.
+ * Besides the total, the time each block spent in a phase is counted in a histogram with two buckets per octave,
+ * from which the latency percentiles are estimated to within a bucket.
+ *
+ * collect() lists the metrics as (name value) pairs, named after the Prometheus conventions,
+ * together with the messages, bytes, drops and queue length of each output port.
+ *
+ *
+ * \author NIDAQmx contributors
+ *
+ * \copyright
+ *
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ *
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/modules/include/NIDAQmxMetrics.h.
+ */
+class NIDAQmxMetrics {
+    public:
+        /**
+         * The timed phases of the acquisition.
+         */
+        enum Phase {
+            PhaseRead = 0,          // Reading a block from the driver, including the wait for it
+            PhaseCalibrate,         // Computing the real values
+            PhasePublish,           // Writing the per-scan, block and saturation messages
+            PhaseEvent,             // Event recorder stage
+            PhaseStatistics,        // Window statistics stage
+            PhaseSpectrum,          // Spectrum stage
+            PhasePreview,           // Preview envelopes
+            NPhases
+        };
+
+        /**
+         * The number of buckets of the latency histograms, two per octave of nanoseconds.
+         */
+        static const int nLatencyBuckets = 64;
+
+        /**
+         * The time spent on one block in each phase, gathered by the processing thread and added once the block is published.
+         */
+        struct BlockTimes {
+            uint64_t times[NPhases];
+            bool timed[NPhases];
+
+            BlockTimes();
+
+            /**
+             * Add the time spent in a phase.
+             * \param i_phase The phase
+             * \param i_start The time the phase started, from nidaqmx::monotonicNanoseconds()
+             * \returns The time the phase ended, to be used as the start of the next one
+             */
+            uint64_t add(const Phase &i_phase, const uint64_t &i_start);
+        };
+
+    private:
+        std::atomic<uint64_t> scansRead;
+        std::atomic<uint64_t> blocksRead;
+        std::atomic<uint64_t> blocksPublished;
+        std::atomic<uint64_t> blocksDropped;
+        std::atomic<uint64_t> driverErrors;
+        std::atomic<uint64_t> overruns;
+        std::atomic<uint64_t> recoveries;
+        std::atomic<uint64_t> backlog;
+        std::atomic<uint64_t> maxBacklog;
+
+        /**
+         * The time spent in each phase in nanoseconds.
+         */
+        std::atomic<uint64_t> phaseTimes[NPhases];
+
+        /**
+         * The number of blocks having spent each time in each phase, by histogram bucket.
+         */
+        std::atomic<uint64_t> phaseLatencies[NPhases][nLatencyBuckets];
+
+        /**
+         * The scan rate measured over the last rateInterval, the start of the current interval and the scans read before it.
+         * Only the reading thread writes them.
+         */
+        std::atomic<double> scanRate;
+        std::atomic<uint64_t> rateStart;
+        uint64_t rateScans;
+
+        /**
+         * The time the counters started.
+         */
+        uint64_t startTime;
+
+        /**
+         * Count the time a block spent in a phase.
+         */
+        void addLatency(const Phase &i_phase, const uint64_t &i_time);
+
+    public:
+        /**
+         * The interval over which the scan rate is measured, in nanoseconds.
+         */
+        static const uint64_t rateInterval = 1000000000ull;
+
+        /**
+         * Default constructor, starting all counters at zero.
+         */
+        NIDAQmxMetrics();
+
+        /**
+         * Get the name of a phase.
+         */
+        static const char *getPhaseName(const Phase &i_phase);
+
+        /**
+         * Count a block read from the driver, from the reading thread.
+         * \param i_nScans The number of scans of the block
+         * \param i_backlog The number of blocks read but not processed yet
+         */
+        void addBlockRead(const size_t &i_nScans, const size_t &i_backlog);
+
+        /**
+         * Count a block published, from the processing thread.
+         * \param i_times The time spent on the block in each phase
+         */
+        void addBlockPublished(const BlockTimes &i_times);
+
+        /**
+         * Count a block read but dropped because all the blocks of the processing strand were in use.
+         */
+        void addBlockDropped(void);
+
+        /**
+         * Count a failed read.
+         * \param i_overrun Whether the input buffer overflowed
+         */
+        void addDriverError(const bool &i_overrun);
+
+        /**
+         * Count a recovery of the DAQ task.
+         */
+        void addRecovery(void);
+
+        /**
+         * Add the time spent in a phase.
+         * \param i_phase The phase
+         * \param i_start The time the phase started, from nidaqmx::monotonicNanoseconds()
+         * \returns The time the phase ended, to be used as the start of the next one
+         */
+        uint64_t addPhaseTime(const Phase &i_phase, const uint64_t &i_start);
+
+        /**
+         * Get the number of blocks timed in a phase.
+         * \param i_phase The phase
+         */
+        uint64_t getPhaseCount(const Phase &i_phase) const;
+
+        /**
+         * Estimate a percentile of the time spent by a block in a phase.
+         * \param i_phase The phase
+         * \param i_quantile The quantile, between 0 and 1
+         * \returns The time in seconds, 0 if no block was timed
+         */
+        double getPhaseLatency(const Phase &i_phase, const double &i_quantile) const;
+
+        /**
+         * List the metrics.
+         * \param i_outputs The output ports
+         * \param o_metrics The metric names and values
+         */
+        void collect(const std::vector<NIDAQmxOutput *> &i_outputs, std::vector<std::pair<std::string, double> > &o_metrics) const;
+};
+
+
+/**
+ * The socket handle type of the platform.
+ */
+#ifdef __linux__
+typedef int NIDAQmxSocket;
+#elif _WIN32
+typedef uintptr_t NIDAQmxSocket;
+#endif
+
+
+/**
+ * The loopback HTTP endpoint serving the metrics as text, in the Prometheus exposition format.
+ * It only accepts connections from the local host, and answers every request with the metrics.
+ */
+class NIDAQmxMetricsServer {
+    private:
+        const NIDAQmxMetrics &metrics;
+        const std::vector<NIDAQmxOutput *> &outputs;
+
+        /**
+         * The listening socket.
+         */
+        NIDAQmxSocket listener;
+
+        std::atomic<bool> stopping;
+        std::thread server;
+
+        /**
+         * The serving thread loop.
+         */
+        void run(void);
+
+        /**
+         * Answer a connection with the metrics.
+         */
+        void serve(NIDAQmxSocket i_connection);
+
+    public:
+        /**
+         * Default constructor.
+         * \param aMetrics The metrics served
+         * \param aOutputs The output ports, which must not change while the server runs
+         */
+        NIDAQmxMetricsServer(const NIDAQmxMetrics &aMetrics, const std::vector<NIDAQmxOutput *> &aOutputs);
+
+        ~NIDAQmxMetricsServer();
+
+        /**
+         * Listen on a loopback port and start serving.
+         * \param i_port The TCP port
+         * \returns false if the port cannot be bound
+         */
+        bool start(const int &i_port);
+
+        /**
+         * Stop serving and close the port.
+         */
+        void stop(void);
+};
+
+#endif
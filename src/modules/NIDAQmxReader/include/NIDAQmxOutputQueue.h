@@ -0,0 +1,414 @@
+/*
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ * Authors: NIDAQmx contributors
+ * website: www.robotcub.org
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+
+/**
+* @ingroup icub_data_acquisition
+*/
+
+
+
+
+#ifndef __NIDAQMXOUTPUTQUEUE_H__
+#define __NIDAQMXOUTPUTQUEUE_H__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/sig/Matrix.h>
+#include <yarp/sig/Vector.h>
+
+#include <NIDAQmxTask/include/NIDAQmxLog.h>
+
+
+/**
+ * The policies applied when an output queue is full.
+ */
+enum NIDAQmxOutputPolicy {
+    OutputStrict,       // The new message is dropped, the queued ones are all delivered in order
+    OutputDropOldest,   // The oldest queued message is dropped to make room for the new one
+    OutputLatest        // Only the latest message is kept, i.e. OutputDropOldest with a depth of one
+};
+
+
+/**
+ * The size of the values of a message, counted by the output queues.
+ * Message types other than these provide their own overload.
+ */
+inline size_t NIDAQmxMessageSize(const yarp::sig::Vector &i_message) {
+    return i_message.size() * sizeof(double);
+}
+
+inline size_t NIDAQmxMessageSize(const yarp::sig::Matrix &i_message) {
+    return (size_t) i_message.rows() * i_message.cols() * sizeof(double);
+}
+
+
+/**
+ * The interface shared by the output queues of all message types.
+ */
+class NIDAQmxOutput {
+    public:
+        virtual ~NIDAQmxOutput() {}
+
+        /**
+         * Get the name of the port.
+         */
+        virtual const std::string &getName(void) const = 0;
+
+        /**
+         * Get the number of connections of the port.
+         */
+        virtual int getOutputCount(void) = 0;
+
+        /**
+         * Set the envelope of the next message written to a timestamp.
+         * \param i_stamp The timestamp
+         */
+        virtual void setEnvelope(const yarp::os::Stamp &i_stamp) = 0;
+
+        /**
+         * Set the envelope of the next message written to a bottle.
+         * \param i_envelope The envelope
+         */
+        virtual void setEnvelope(const yarp::os::Bottle &i_envelope) = 0;
+
+        /**
+         * Get the policy applied when the queue is full.
+         */
+        virtual NIDAQmxOutputPolicy getPolicy(void) const = 0;
+
+        /**
+         * Get the maximum number of messages waiting to be sent.
+         */
+        virtual size_t getDepth(void) const = 0;
+
+        /**
+         * Get the number of messages waiting to be sent.
+         */
+        virtual size_t getQueued(void) = 0;
+
+        /**
+         * Get the number of messages dropped so far.
+         */
+        virtual unsigned long getDropped(void) const = 0;
+
+        /**
+         * Get the number of messages sent so far.
+         */
+        virtual unsigned long getSent(void) const = 0;
+
+        /**
+         * Get the size of the values of the messages sent so far, without the port headers and envelopes.
+         */
+        virtual unsigned long long getSentBytes(void) const = 0;
+};
+
+
+/**
+ * \class NIDAQmxOutputQueue
+ *
+ * \brief The NIDAQmxOutputQueue decouples the writes of the module from the readers of a port.
+ *
+ *
+ * \section intro_sec Description
+ * The messages written by the module are copied into a bounded queue and sent by a thread of their own,
+ * which waits for each message to be delivered before sending the next one.
+ * A slow reader therefore only slows this thread down: once the queue is full, messages are dropped according to the
+ * NIDAQmxOutputPolicy of the queue and counted, and the thread writing the messages never waits for the readers.
+ *
+ * The message buffers are allocated when the queue is opened and reused, so that writing a message does not allocate memory
+ * once the buffers have grown to the message size.
+ *
+ * prepare(), setEnvelope() and write() must be called by one thread at a time.
+ *
+ *
+ * \author NIDAQmx contributors
+ *
+ * \copyright
+ *
+ * Copyright (C) 2026 iCub Facility - Istituto Italiano di Tecnologia
+ *
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ * This file can be edited at contrib/src/dataAcquisition/NIDAQmx/src/modules/include/NIDAQmxOutputQueue.h.
+ */
+template <class T>
+class NIDAQmxOutputQueue : public NIDAQmxOutput {
+    private:
+        /**
+         * A message and its envelope.
+         */
+        struct Message {
+            T data;
+            yarp::os::Stamp stamp;
+            yarp::os::Bottle envelope;
+            bool hasEnvelope;
+
+            Message() : hasEnvelope(false) {}
+        };
+
+        /**
+         * The port the messages are sent on.
+         */
+        yarp::os::BufferedPort<T> port;
+
+        /**
+         * The port name.
+         */
+        std::string name;
+
+        /**
+         * The policy applied when the queue is full.
+         */
+        NIDAQmxOutputPolicy policy;
+
+        /**
+         * The maximum number of queued messages.
+         */
+        size_t depth;
+
+        /**
+         * The message buffers: the queued ones, the one being filled, the one being sent and the free ones.
+         */
+        std::vector<Message> slots;
+
+        /**
+         * The indices of the queued messages, oldest first.
+         */
+        std::deque<size_t> queued;
+
+        /**
+         * The indices of the free message buffers.
+         */
+        std::vector<size_t> freeSlots;
+
+        /**
+         * The index of the message being filled.
+         */
+        size_t filling;
+
+        /**
+         * The number of messages dropped.
+         */
+        std::atomic<unsigned long> dropped;
+
+        /**
+         * The number of messages sent and the size of their values.
+         */
+        std::atomic<unsigned long> sent;
+        std::atomic<unsigned long long> sentBytes;
+
+        /**
+         * Rate limiter for the warning on dropped messages.
+         */
+        nidaqmx::NIDAQmxLogLimiter dropLogLimiter;
+
+        std::mutex mutex;
+        std::condition_variable available;
+        bool stopping;
+        std::thread sender;
+
+        /**
+         * The sending thread loop.
+         */
+        void run(void) {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            for (;;) {
+                while (queued.empty() && !stopping) {
+                    available.wait(lock);
+                }
+                if (stopping) {
+                    return;
+                }
+
+                size_t sending = queued.front();
+                queued.pop_front();
+                lock.unlock();
+
+                Message &message = slots[sending];
+                if (message.hasEnvelope) {
+                    port.setEnvelope(message.envelope);
+                } else {
+                    port.setEnvelope(message.stamp);
+                }
+                port.prepare() = message.data;
+                port.write(true);
+                port.waitForWrite();
+                sent.fetch_add(1, std::memory_order_relaxed);
+                sentBytes.fetch_add(NIDAQmxMessageSize(message.data), std::memory_order_relaxed);
+
+                lock.lock();
+                freeSlots.push_back(sending);
+            }
+        }
+
+    public:
+        /**
+         * Default constructor.
+         */
+        NIDAQmxOutputQueue() : policy(OutputStrict), depth(1), filling(0), dropped(0), sent(0), sentBytes(0), dropLogLimiter(1.0), stopping(false) {
+        }
+
+        virtual ~NIDAQmxOutputQueue() {
+            close();
+        }
+
+        /**
+         * Open the port and start the sending thread.
+         * \param i_name The port name
+         * \param i_policy The policy applied when the queue is full
+         * \param i_depth The maximum number of queued messages, ignored by OutputLatest
+         */
+        bool open(const std::string &i_name, const NIDAQmxOutputPolicy &i_policy, const size_t &i_depth) {
+            name = i_name;
+            policy = i_policy;
+            depth = (policy == OutputLatest) ? 1 : std::max(i_depth, (size_t) 1);
+
+            // Room for the queued messages, the one being filled and the one being sent
+            slots.assign(depth + 2, Message());
+            queued.clear();
+            freeSlots.clear();
+            for (size_t i = 1; i < slots.size(); ++i) {
+                freeSlots.push_back(i);
+            }
+            filling = 0;
+
+            if (!port.open(name.c_str())) {
+                return false;
+            }
+            stopping = false;
+            sender = std::thread(&NIDAQmxOutputQueue::run, this);
+
+            return true;
+        }
+
+        /**
+         * Interrupt the port, releasing a write waiting for a reader.
+         */
+        void interrupt(void) {
+            port.interrupt();
+        }
+
+        /**
+         * Stop the sending thread, dropping the queued messages, and close the port.
+         */
+        void close(void) {
+            if (sender.joinable()) {
+                mutex.lock();
+                stopping = true;
+                mutex.unlock();
+                available.notify_one();
+                port.interrupt();
+                sender.join();
+            }
+            port.close();
+        }
+
+        /**
+         * Get the message to fill before calling write().
+         */
+        T &prepare(void) {
+            return slots[filling].data;
+        }
+
+        virtual void setEnvelope(const yarp::os::Stamp &i_stamp) {
+            slots[filling].stamp = i_stamp;
+            slots[filling].hasEnvelope = false;
+        }
+
+        virtual void setEnvelope(const yarp::os::Bottle &i_envelope) {
+            slots[filling].envelope = i_envelope;
+            slots[filling].hasEnvelope = true;
+        }
+
+        /**
+         * Queue the prepared message for sending, applying the policy if the queue is full.
+         * This never waits for the readers.
+         */
+        void write(void) {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (queued.size() >= depth) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+
+                unsigned int suppressed;
+                if (dropLogLimiter.allow(suppressed)) {
+                    nidaqmx::NIDAQmxLog::log(nidaqmx::NIDAQmxLog::Warning, "NIDAQmxOutputQueue: Warning: %s is not keeping up, %lu messages dropped so far.",
+                            name.c_str(), dropped.load(std::memory_order_relaxed));
+                }
+
+                if (policy == OutputStrict) {   // Keep the buffer for the next message
+                    return;
+                }
+                freeSlots.push_back(queued.front());
+                queued.pop_front();
+            }
+
+            queued.push_back(filling);
+            filling = freeSlots.back();
+            freeSlots.pop_back();
+            lock.unlock();
+
+            available.notify_one();
+        }
+
+        virtual const std::string &getName(void) const {
+            return name;
+        }
+
+        virtual int getOutputCount(void) {
+            return port.getOutputCount();
+        }
+
+        virtual NIDAQmxOutputPolicy getPolicy(void) const {
+            return policy;
+        }
+
+        virtual size_t getDepth(void) const {
+            return depth;
+        }
+
+        virtual size_t getQueued(void) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return queued.size();
+        }
+
+        virtual unsigned long getDropped(void) const {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        virtual unsigned long getSent(void) const {
+            return sent.load(std::memory_order_relaxed);
+        }
+
+        virtual unsigned long long getSentBytes(void) const {
+            return sentBytes.load(std::memory_order_relaxed);
+        }
+};
+
+#endif
@@ -60,6 +60,28 @@
  *     - <i>samplesPerChannel</i>
  *
  * 
+ * \section recovery_sec Error Recovery
+ * A failed read does not stop the module. Read timeouts are retried up to <i>timeouts</i> times in a row,
+ * any other driver error (buffer overflow, device removed, etc.) stops, clears and recreates the DAQ task within <i>budget</i> seconds.
+ * If the task is still not acquiring, the recovery is tried again at the next period until the device comes back.
+ * The gap is then reported on gap:o and the time spent recovering is accumulated for getAvailability.
+ *
+ *
+ * \section benchmark_sec Simulation and Benchmark
+ * With <i>--simulate</i> the module acquires from a simulated device instead of the DAQ card, without calling the driver:
+ * every channel holds a sine wave within its minVals and maxVals, the counters count scans, and scans left unread for longer than
+ * the buffer are lost as on an overrun. Triggered acquisition is not simulated. The sampling rate can be overridden with <i>--rate</i>,
+ * and <i>--channels</i> replicates the configured sensor (channels, calibration, bias, output transform and event thresholds)
+ * up to the given number of channels, which must be a multiple of the configured one.
+ *
+ * With <i>--benchmark</i> the executable runs the configured pipeline against the simulated device for <i>--duration</i> seconds (default 10)
+ * and reports on the terminal the sustained scan rate, the overruns and backlog, the messages and bytes written, the percentiles
+ * of the time spent by a block in each processing phase and the CPU time used. No yarp server is needed: the ports are registered
+ * within the process, and every output port is read by a local reader discarding the messages, so that the whole block is processed.
+ * For instance, NIDAQmxReader --benchmark --rate 20000 --channels 24 --duration 30 --processing pool
+ * measures four sensors at 20 kHz with the calibration, block and stage work spread on the worker pool.
+ *
+ * 
  * \section lib_sec Libraries
  * The NIDAQmxReader depends on standard YARP libraries.
  * 
@@ -71,31 +93,145 @@
  *     - <i>name</i>: The module name.
  *     - <i>period</i>: The module period in seconds.
  *     - <i>robot</i>: The robot on which the module will run.
+ *     - <i>simulate</i>: Acquire from a simulated device, see above.
+ *     - <i>rate</i>, <i>channels</i>: The sampling rate and number of channels of the simulated device.
+ *     - <i>benchmark</i>: Run the pipeline against the simulated device for <i>duration</i> seconds and report its throughput, latency and CPU use.
  *  
  * <b>Configuration File Parameters </b>
  *     - <i>name</i>: The module name.
  *     - <i>period</i>: The module period in seconds.
  *     - <i>robot</i>: The robot on which the module will run.
+ *     - <i>verbosity</i>: The log verbosity, one of error, warning, info (default) or debug.
+ *     - <i>scanEnvelope</i> (optional): The output ports, e.g. (analog gap), whose messages are sent with the scan envelope instead of a yarp::os::Stamp.
+ *       The scan envelope is a yarp::os::Bottle (count time scan discontinuity) which readers expecting a yarp::os::Stamp, such as yarpdatadumper,
+ *       yarpscope or getEnvelope(yarp::os::Stamp&), cannot decode: only list the ports whose readers all expect it.
+ *     - <i>compression</i>: The encoding of realQuantised:o: none (default), BlockInt16 values sent as they are,
+ *       or delta, BlockInt16Delta values losslessly packed from the differences between consecutive scans, usually several times smaller.
+ *     - <i>processing</i>: Where the blocks are calibrated, published and fed to the stages: inline (default) on the reading thread,
+ *       or pool on the worker pool shared by all the DAQ tasks of the process, so that the reading thread only reads.
+ *       At most 16 blocks wait to be processed: further blocks are dropped and counted, and the next block published is flagged as following an overrun.
  *     - <i>deviceName</i>: The DAQ device name.
  *     - <i>taskName</i>: The DAQ task name.
  *     - <i>channels</i>: The physical channels to sample.
  *     - <i>channelType</i>: The physical channel type - (see http://zone.ni.com/reference/en-XX/help/370471W-01/TOC8.htm).
- *     - <i>terminalConfig</i>: The terminal configuration mode for each channel - (see http://zone.ni.com/reference/en-XX/help/370466V-01/measfunds/connectaisigs/).
+ *       One of AIVoltage, AICurrent (NIDAQmx only) or AIThermocoupleX where X is the thermocouple type (B, E, J, K, N, R, S, T).
+ *       Channels of different types are sampled together and appear in the same order as in <i>channels</i>.
+ *     - <i>terminalConfig</i>: The terminal configuration mode for each channel, one of Default, Diff, RSE, NRSE - (see http://zone.ni.com/reference/en-XX/help/370466V-01/measfunds/connectaisigs/).
  *     - <i>minVals</i>: The minimum values to be read for each channel.
  *     - <i>maxVals</i>: The maximum values to be read for each channel.
  *     - <i>samplesPerChannel</i>: The number of samples to read per channel.
  *     - <i>samplingRate</i>: The sampling rate in Hz.
  *     - <i>timeout</i>: The sampling timeout in ms.
  *     - <i>bufferSize</i>: The sampling buffer size.
- *     - <i>scales</i>: The calibration scales.
- *     - <i>calibMatrix</i>: The calibration matrix.
+ *     - <i>triggerType</i>: None (continuous acquisition, default), AnalogEdge or DigitalEdge.
+ *       In triggered mode the device captures a window around each trigger, which is published as a burst of scans once complete.
+ *     - <i>triggerSource</i>: The trigger source relative to the device, an analog input (e.g. ai0) for AnalogEdge or a terminal (e.g. PFI0) for DigitalEdge.
+ *     - <i>triggerSlope</i>: The trigger slope or edge, Rising or Falling.
+ *     - <i>triggerLevel</i>: The AnalogEdge trigger level in the units of the source channel.
+ *     - <i>preTriggerSamples</i>: The number of samples per channel captured before the trigger.
+ *     - <i>postTriggerSamples</i>: The number of samples per channel captured from the trigger onwards.
+ *     - <i>scales</i>: The calibration scales, one for each real sensor value computed.
+ *     - <i>calibMatrix</i>: The calibration matrix, row after row, with one row per scale and one column per channel.
+ *       Fewer rows than channels leave auxiliary channels (temperature, excitation monitor, etc.) uncalibrated: they are only published on analog:o.
+ *     - <i>bias</i> (optional): The bias subtracted from the scaled values, e.g. the unloaded sensor reading, one value per scale.
+ *     - <i>outputTransform</i> (optional): The square matrix applied last to the unbiased values, e.g. the 6x6 wrench transform to a tool frame.
+ *       The calibration matrix, scales, bias and output transform are composed into a single affine map when the module starts.
+ *     - [DAQCounters] (optional) <i>channels</i>: The counters to acquire alongside the analog channels, e.g. (ctr0).
+ *     - [DAQCounters] <i>channelType</i>: The counter type for each counter, one of CIAngEncoder, CILinEncoder or CICountEdges.
+ *     - [DAQCounters] <i>scales</i>: The pulses per revolution (CIAngEncoder) or distance per pulse (CILinEncoder) for each counter, ignored by CICountEdges.
+ *     - [DAQEvents] (optional) <i>thresholds</i>: The threshold on the absolute value of each real sensor value triggering an event snapshot, one per calibrated output, 0 to ignore an output.
+ *     - [DAQEvents] <i>preTrigger</i>: The time kept before the threshold crossing in seconds.
+ *     - [DAQEvents] <i>postTrigger</i>: The time captured from the threshold crossing onwards in seconds.
+ *     - [DAQStatistics] (optional) <i>window</i>: The length of the statistics windows in seconds.
+ *     - [DAQSpectrum] (optional) <i>fftSize</i>: The FFT length in scans, rounded up to a power of two. Segments overlap by half.
+ *     - [DAQSpectrum] <i>averages</i>: The number of segments averaged for each estimate (Welch's method).
+ *     - [DAQSpectrum] <i>bands</i>: The lower and upper frequency in Hz of each band, e.g. (0 50 200 400).
+ *     - [DAQPreview] (optional) <i>rate</i>: The rate in Hz of the preview envelopes meant for yarpscope, e.g. 60.
+ *     - [DAQOutputs] (optional) <i>analog</i>, <i>real</i>, <i>analogBlock</i>, <i>realBlock</i>, <i>realQuantised</i>, <i>event</i>, <i>stats</i>, <i>spectrum</i>, <i>saturation</i>, <i>analogPreview</i>,
+ *       <i>realPreview</i>, <i>gap</i>: The policy of each output port followed by its queue depth, e.g. (dropOldest 4096), see below.
+ *     - [DAQRecovery] (optional) <i>budget</i>: The time allowed to each restart of a failed DAQ task in seconds (default 5).
+ *     - [DAQRecovery] <i>timeouts</i>: The number of consecutive read timeouts tolerated before the DAQ task is restarted (default 3).
+ *     - [DAQMetrics] (optional) <i>httpPort</i>: The local TCP port of the HTTP endpoint serving the metrics, e.g. 9101, see below.
+ *     - [DAQMulticast] (optional) <i>analog</i>, <i>real</i>, <i>analogBlock</i>, etc.: The output ports published by multicast, each followed by
+ *       the list of readers connected to it at start-up, e.g. realPreview (/scope1/in /scope2/in), see below.
  *  
  * 
  * \section portsc_sec Ports Created
  * <b>Output ports </b>
  * The NIDAQmxReader creates the following output ports:
  *     - /NIDAQmxReader/data/analog:o [yarp::sig::Vector]  [default carrier:tcp]: This port outputs the analog sensor values (Volts, Amps, etc).
- *     - /NIDAQmxReader/data/real:o [yarp::sig::Vector]  [default carrier:tcp]: This port outputs the real sensor values (Newtons, Newton millimeters, etc).
+ *     - /NIDAQmxReader/data/real:o [yarp::sig::Vector]  [default carrier:tcp]: This port outputs the real sensor values (Newtons, Newton millimeters, etc),
+ *       one for each calibration matrix row.
+ *       When counters are configured their values (degrees, meters, ticks), latched on the same sample clock edge, are appended to each scan.
+ *     - /NIDAQmxReader/data/analogBlock:o and /NIDAQmxReader/data/realBlock:o [NIDAQmxBlockMessage]  [default carrier:tcp]: These ports output the same values
+ *       as analog:o and real:o, one message per block instead of one per scan. Each message holds a NIDAQmxBlockHeader (first scan index, time of the first scan,
+ *       time between scans, number of channels and scans, value type, discontinuity flags) followed by the values, which readers use in place.
+ *       They are meant for readers of the full-rate data, for which the per-scan ports cost one port write per scan.
+ *     - /NIDAQmxReader/data/realQuantised:o [NIDAQmxBlockMessage]  [default carrier:tcp]: This port outputs the real sensor values of each block,
+ *       without the counters, quantised to 16-bit integers (BlockInt16). The message carries the scale and offset of each channel,
+ *       from which the values are recovered as offset + scale * q. The range of each channel is derived from the minVals and maxVals
+ *       of the analog channels through the calibration, so that one step is about the contribution of one ADC step.
+ *       It is meant for remote readers over slow links, its payload being a quarter of that of realBlock:o.
+ *     - /NIDAQmxReader/data/event:o [yarp::sig::Matrix]  [default carrier:tcp]: This port outputs the real sensor values surrounding each threshold crossing,
+ *       one row per scan and one column per calibrated output, when [DAQEvents] are configured. It can be recorded to file with yarpdatadumper.
+ *     - /NIDAQmxReader/data/stats:o [yarp::sig::Vector]  [default carrier:tcp]: This port outputs the statistics of the real sensor values
+ *       over each window when [DAQStatistics] are configured: the minimum of every channel, then the maximum, mean, RMS and variance.
+ *     - /NIDAQmxReader/data/spectrum:o [yarp::sig::Vector]  [default carrier:tcp]: This port outputs the energy of the real sensor values
+ *       in each band after every spectrum estimate when [DAQSpectrum] is configured: all the bands of the first channel, then of the second, etc.
+ *     - /NIDAQmxReader/data/saturation:o [yarp::sig::Vector]  [default carrier:tcp]: For every block in which analog values reach the configured
+ *       minVals or maxVals, this port outputs the number of such values for each channel followed by the number of scans affected,
+ *       then for each of these scans its index within the block and the mask of its channels at the limits (bit i for channel i, the first 32 channels only).
+ *     - /NIDAQmxReader/data/analogPreview:o and /NIDAQmxReader/data/realPreview:o [yarp::sig::Vector]  [default carrier:tcp]: When [DAQPreview] is configured,
+ *       these ports output the analog and real values decimated to the preview rate: each message holds the minimum of every channel over the
+ *       preview period, followed by the maximum of every channel. GUIs should read these ports instead of the full-rate ones.
+ *     - /NIDAQmxReader/data/gap:o [yarp::sig::Vector]  [default carrier:tcp]: Each time the DAQ task is recovered after a driver error,
+ *       this port outputs the driver error code, the duration of the gap in seconds, the number of recoveries so far and their total duration,
+ *       followed by the index of the first scan after the gap and its discontinuity flags.
+ *       No scan is published during the gap, and the processing stages restart after it.
+ *
+ * Each message carries the index of the scan it refers to, counted since the task was created:
+ * the scan itself on analog:o and real:o, the first scan of the block on the block ports and saturation:o, the last scan processed on the stage ports,
+ * the last scan of each bin on the preview ports and the first scan after the gap on gap:o.
+ * The yarp::os::Stamp count is this index, wrapped to 31 bits, so that Stamp readers detect lost messages from the count.
+ * The full index is held in the header of the block messages, on gap:o and in the scan envelope, where it is sent as a double, exact up to 2^53 scans.
+ * The discontinuity flags (1 overrun, 2 recovery, 4 restart) are set there on the first message following lost scans,
+ * so that a reader detects losses by checking that each index follows the previous one.
+ *
+ * Each output port has a bounded queue of messages sent by a thread of its own, so that a slow reader never stalls the acquisition.
+ * When a queue is full the port policy decides which message is dropped, and the drops are counted:
+ *     - strict: the new message is dropped, so the queued ones are delivered without holes (default for the block ports including realQuantised, depth 64,
+ *       and for event, stats, spectrum, saturation and gap, depth 16)
+ *     - dropOldest: the oldest queued message is dropped (default for analog and real, depth 4096, and for the previews, depth 64)
+ *     - latest: only the latest message is kept, for readers only interested in the current value
+ *
+ * Each block is only written to the ports which have at least one reader. The real sensor values are not even computed
+ * while neither real:o nor the port of a processing stage is read, and a stage whose port is not read is not fed:
+ * its statistics, spectrum or pre-trigger history restart when a reader connects.
+ *
+ * The ports listed under [DAQMulticast] are meant for many readers, e.g. several monitors and a controller reading the same block port:
+ * their readers are connected with the mcast carrier, so that each message is sent once to a multicast group shared by all of them
+ * instead of once per TCP connection. The listed readers are connected when the module starts, and others may join later with
+ * the subscribe rpc command or with yarp connect port reader mcast.
+ * Multicast is UDP: a message lost on the network is lost for its reader, and a message larger than a datagram is lost whole if one
+ * of its fragments is. Readers of the block ports detect the lost messages from the scan index carried in the block header;
+ * their envelope only changes if they are listed in scanEnvelope, so that the Stamp readers of the same ports are not affected.
+ *
+ * The module counts the scans read and their rate, the blocks read, published and dropped, the driver errors, overruns and recoveries,
+ * the blocks waiting to be processed, the time spent in each processing phase with its median, 90th and 99th percentile per block,
+ * and the messages, bytes and drops of each output port.
+ * These metrics are returned by the getMetrics rpc command, and served as text in the Prometheus format at http://127.0.0.1:httpPort/
+ * when [DAQMetrics] is configured. The endpoint is started once the DAQ task is ready and only listens on the loopback interface.
+ *
+ * <b>Input ports </b>
+ *     - /NIDAQmxReader/rpc:i: The rpc port accepting the following commands:
+ *         - <i>setCalib (scales) (calibMatrix)</i>: Replace the calibration scales and matrix, keeping the number of rows. The running acquisition picks them up on its next block.
+ *         - <i>setSampling samplesPerChannel samplingRate [bufferSize]</i>: Restart the DAQ task with new sampling parameters, keeping its channels.
+ *         - <i>getOutputs</i>: Reply with one list per output port holding its name, policy, queue depth, queued messages and dropped messages.
+ *         - <i>subscribe port reader</i>: Connect a reader to an output port listed under [DAQMulticast], e.g. subscribe realBlock /controller/ft:i.
+ *         - <i>getMetrics</i>: Reply with one (name value) list per metric.
+ *         - <i>getAvailability</i>: Reply with the number of recoveries, the duration of the last gap, the total duration of the gaps
+ *           and the fraction of time the task has been acquiring since the module started.
+ *         - <i>help</i>: List the available commands.
  * 
  * 
  * \section supported_daq_cards Supported National Instruments DAQ cards
@@ -121,14 +257,29 @@
 #ifndef __NIDAQMXREADERMODULE_H__
 #define __NIDAQMXREADERMODULE_H__
 
+#include <atomic>
 #include <vector>
 
 #include <yarp/os/RFModule.h>
 #include <yarp/os/BufferedPort.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Mutex.h>
+#include <yarp/os/Semaphore.h>
 #include <yarp/os/Stamp.h>
+#include <yarp/sig/Matrix.h>
 #include <yarp/sig/Vector.h>
 
 #include <NIDAQmxTask/include/NIDAQmxTask.h>
+#include <NIDAQmxTask/include/NIDAQmxEnvelope.h>
+#include <NIDAQmxTask/include/NIDAQmxEventRecorder.h>
+#include <NIDAQmxTask/include/NIDAQmxQuantiser.h>
+#include <NIDAQmxTask/include/NIDAQmxSpectrum.h>
+#include <NIDAQmxTask/include/NIDAQmxWindowStatistics.h>
+#include <NIDAQmxTask/include/NIDAQmxWorkerPool.h>
+
+#include "NIDAQmxBlockMessage.h"
+#include "NIDAQmxMetrics.h"
+#include "NIDAQmxOutputQueue.h"
 
 
 /**
@@ -159,28 +310,414 @@ class NIDAQmxReaderModule : public yarp::os::RFModule {
          */
         nidaqmx::NIDAQmxTaskParams DAQTaskConfig;
 
+        /**
+         * The number of real sensor values computed for each scan, i.e. the number of calibration scales.
+         */
+        size_t DAQNOutputs;
+
         /* ******* DAQ task objects                              ******* */
         /**
          * The NIDAQmxTAsk object.
          */
         nidaqmx::NIDAQmxTask *DAQTask;
+
+        /* ******* Processing stages                             ******* */
+        /**
+         * The stages fed with every block of real sensor values, in order.
+         */
+        std::vector<nidaqmx::NIDAQmxStage *> DAQStages;
+
+        /**
+         * The port publishing the results of each stage.
+         * A stage is only fed while its port has readers.
+         */
+        std::vector<NIDAQmxOutput *> DAQStagePorts;
+
+        /**
+         * The metrics phase each stage is timed under.
+         */
+        std::vector<NIDAQmxMetrics::Phase> DAQStagePhases;
+
+        /**
+         * Whether each stage was fed the last block.
+         */
+        std::vector<bool> DAQStagesFed;
+
+        /**
+         * The event recorder, also held in DAQStages, or NULL if no [DAQEvents] are configured.
+         */
+        nidaqmx::NIDAQmxEventRecorder *eventRecorder;
+
+        /**
+         * The event thresholds for each real sensor value.
+         */
+        std::vector<double> eventThresholds;
+
+        /**
+         * The time kept before an event in seconds.
+         */
+        double eventPreTrigger;
+
+        /**
+         * The time captured after an event in seconds.
+         */
+        double eventPostTrigger;
+
+        /**
+         * The last collected event snapshot.
+         */
+        std::vector<double> eventScans;
+
+        /**
+         * The windowed statistics, also held in DAQStages, or NULL if no [DAQStatistics] are configured.
+         */
+        nidaqmx::NIDAQmxWindowStatistics *windowStatistics;
+
+        /**
+         * The statistics window length in seconds.
+         */
+        double statisticsWindow;
+
+        /**
+         * The last collected window statistics.
+         */
+        nidaqmx::NIDAQmxStatistics statistics;
+
+        /**
+         * The spectral analysis, also held in DAQStages, or NULL if no [DAQSpectrum] is configured.
+         */
+        nidaqmx::NIDAQmxSpectrum *spectrum;
+
+        /**
+         * The spectrum FFT length, 0 if disabled.
+         */
+        int spectrumFFTSize;
+
+        /**
+         * The number of segments averaged for each spectrum estimate.
+         */
+        int spectrumAverages;
+
+        /**
+         * The spectrum band edges in Hz, one pair per band.
+         */
+        std::vector<double> spectrumBands;
+
+        /**
+         * The last collected band energies.
+         */
+        std::vector<double> bandEnergies;
+
+        /**
+         * The envelope of the real sensor values, also held in DAQStages, or NULL if no [DAQPreview] is configured.
+         */
+        nidaqmx::NIDAQmxEnvelope *realPreview;
+
+        /**
+         * The envelope of the analog values, fed apart from the stages, or NULL if no [DAQPreview] is configured.
+         */
+        nidaqmx::NIDAQmxEnvelope *analogPreview;
+
+        /**
+         * Whether the analog envelope was fed the last block.
+         */
+        bool analogPreviewFed;
+
+        /**
+         * The discontinuity flags to set on the next bin written on analogPreview:o and realPreview:o.
+         */
+        unsigned int analogPreviewDiscontinuity;
+        unsigned int realPreviewDiscontinuity;
+
+        /**
+         * The quantiser of the real sensor values published on realQuantised:o.
+         */
+        nidaqmx::NIDAQmxQuantiser *realQuantiser;
+
+        /**
+         * Whether realQuantised:o is packed with the NIDAQmxDeltaCodec.
+         */
+        bool deltaCompression;
+
+        /**
+         * The quantised values of the last block, kept to be packed.
+         */
+        std::vector<int16> quantisedValues;
+
+        /**
+         * The ranges matching a calibration set over rpc, applied by the processing thread when it swaps in the calibration.
+         * The mutex is held by the rpc thread from setCalibrationConfig() until the ranges are set, so that both are swapped in with the same block.
+         */
+        std::vector<double> quantiserMin;
+        std::vector<double> quantiserMax;
+        yarp::os::Mutex quantiserMutex;
+        std::atomic<bool> quantiserPending;
+
+        /**
+         * The preview rate in Hz, 0 if disabled.
+         */
+        double previewRate;
+
+        /**
+         * The last collected envelope bins.
+         */
+        std::vector<double> previewEnvelopes;
         
         /* ****** Ports                                         ****** */
         /** 
          * Output port for sensor analog values. 
          */
-        yarp::os::BufferedPort<yarp::sig::Vector> portNIDAQmxReaderOutAnalog;
+        NIDAQmxOutputQueue<yarp::sig::Vector> portNIDAQmxReaderOutAnalog;
 
         /** 
          * Output port for sensor real values.
          */
-        yarp::os::BufferedPort<yarp::sig::Vector> portNIDAQmxReaderOutReal;
+        NIDAQmxOutputQueue<yarp::sig::Vector> portNIDAQmxReaderOutReal;
+
+        /**
+         * Output ports for whole blocks of sensor analog and real values.
+         */
+        NIDAQmxOutputQueue<NIDAQmxBlockMessage> portNIDAQmxReaderOutAnalogBlock;
+        NIDAQmxOutputQueue<NIDAQmxBlockMessage> portNIDAQmxReaderOutRealBlock;
+
+        /**
+         * Output port for whole blocks of quantised sensor real values.
+         */
+        NIDAQmxOutputQueue<NIDAQmxBlockMessage> portNIDAQmxReaderOutRealQuantised;
+
+        /**
+         * Output port for event snapshots.
+         */
+        NIDAQmxOutputQueue<yarp::sig::Matrix> portNIDAQmxReaderOutEvent;
+
+        /**
+         * Output port for windowed statistics.
+         */
+        NIDAQmxOutputQueue<yarp::sig::Vector> portNIDAQmxReaderOutStats;
+
+        /**
+         * Output port for spectrum band energies.
+         */
+        NIDAQmxOutputQueue<yarp::sig::Vector> portNIDAQmxReaderOutSpectrum;
+
+        /**
+         * Output port for saturation counts.
+         */
+        NIDAQmxOutputQueue<yarp::sig::Vector> portNIDAQmxReaderOutSaturation;
+
+        /**
+         * Output ports for the display-rate envelopes of the analog and real values.
+         */
+        NIDAQmxOutputQueue<yarp::sig::Vector> portNIDAQmxReaderOutAnalogPreview;
+        NIDAQmxOutputQueue<yarp::sig::Vector> portNIDAQmxReaderOutRealPreview;
+
+        /**
+         * Output port for the gaps left by the recoveries of the DAQ task.
+         */
+        NIDAQmxOutputQueue<yarp::sig::Vector> portNIDAQmxReaderOutGap;
+
+        /**
+         * All the output ports, in the order they are listed by the getOutputs rpc command.
+         */
+        std::vector<NIDAQmxOutput *> outputs;
+
+        /**
+         * The keys of the output ports listed under [DAQMulticast].
+         */
+        std::vector<std::string> multicastOutputs;
+
+        /**
+         * RPC port used to reconfigure the running module.
+         */
+        yarp::os::Port portNIDAQmxReaderRPC;
 
         /** 
          * The port timestamp. 
          */
         yarp::os::Stamp portStamp;
 
+        /**
+         * The ports whose messages are stamped with scanStamp instead of a yarp::os::Stamp.
+         */
+        std::vector<NIDAQmxOutput*> scanEnvelopeOutputs;
+
+        /**
+         * The envelope holding the timestamp, the scan index and the discontinuity flags.
+         */
+        yarp::os::Bottle scanStamp;
+
+        /**
+         * The index of the last scan of the block being processed, stamped on the outputs of the stages.
+         */
+        uInt64 lastScan;
+
+        /* ****** Live reconfiguration                          ****** */
+        /**
+         * The sampling configuration requested over rpc, applied by updateModule().
+         */
+        nidaqmx::NIDAQmxSamplingConfig samplingChange;
+
+        /**
+         * Whether samplingChange is waiting to be applied.
+         */
+        std::atomic<bool> samplingChangePending;
+
+        /**
+         * The outcome of the last sampling reconfiguration.
+         */
+        std::atomic<bool> samplingChangeResult;
+
+        /**
+         * Serialises sampling reconfiguration requests.
+         */
+        yarp::os::Mutex samplingChangeMutex;
+
+        /**
+         * Posted once samplingChange has been applied, or by interruptModule() if it is still pending.
+         * Whoever clears samplingChangePending posts it, so that it is posted once per request.
+         */
+        yarp::os::Semaphore samplingChangeDone;
+
+        /* ****** Error recovery                                ****** */
+        /**
+         * The time allowed to each recovery of the DAQ task in seconds.
+         */
+        double recoveryBudget;
+
+        /**
+         * The number of consecutive transient read errors tolerated before the DAQ task is restarted.
+         */
+        int recoveryTimeouts;
+
+        /**
+         * The number of consecutive transient read errors.
+         */
+        int transientErrors;
+
+        /**
+         * Whether the DAQ task failed and has not been recovered yet.
+         */
+        bool DAQTaskLost;
+
+        /**
+         * The monotonic time of the failure of the DAQ task.
+         */
+        double gapStart;
+
+        /**
+         * The driver error code which caused the failure.
+         */
+        int gapError;
+
+        /**
+         * The monotonic time the acquisition started, to compute the availability.
+         */
+        double startTime;
+
+        /**
+         * The number of recoveries so far.
+         */
+        int nRecoveries;
+
+        /**
+         * The duration of the last gap in seconds.
+         */
+        double lastGap;
+
+        /**
+         * The total duration of the gaps so far in seconds.
+         */
+        double totalDowntime;
+
+        /**
+         * Guards the recovery state read by the rpc thread.
+         */
+        yarp::os::Mutex recoveryMutex;
+
+        /**
+         * Rate limiter for the messages logged while the DAQ task cannot be recovered.
+         */
+        nidaqmx::NIDAQmxLogLimiter recoveryLogLimiter;
+
+        /* ****** Block processing                              ****** */
+        /**
+         * A block read by updateModule() and processed on the module strand.
+         */
+        class BlockJob : public nidaqmx::NIDAQmxJob {
+            public:
+                /**
+                 * The block read.
+                 */
+                nidaqmx::NIDAQmxResults results;
+
+                /**
+                 * The time the block was read, which its messages are stamped with.
+                 */
+                double readTime;
+
+                /**
+                 * Default constructor.
+                 * \param aModule The module processing the block
+                 */
+                BlockJob(NIDAQmxReaderModule *aModule);
+
+                /**
+                 * Calibrate and publish the block.
+                 */
+                virtual void run(void);
+
+                /**
+                 * Return the job to the free ones of the module instead of deleting it.
+                 */
+                virtual void release(void);
+
+            private:
+                NIDAQmxReaderModule *module;
+        };
+
+        /**
+         * The strand on which the blocks are processed in the shared worker pool, or NULL to process them on the reading thread.
+         */
+        nidaqmx::NIDAQmxStrand *DAQStrand;
+
+        /**
+         * The number of blocks which can wait on the strand, allocated once.
+         */
+        static const size_t nBlockJobs = 16;
+
+        /**
+         * All the block jobs, and those not holding a block waiting on the strand.
+         */
+        std::vector<BlockJob*> blockJobs;
+        std::vector<BlockJob*> freeBlockJobs;
+        yarp::os::Mutex blockJobsMutex;
+
+        /**
+         * The block read while all the block jobs were in use, which is dropped.
+         */
+        nidaqmx::NIDAQmxResults droppedResults;
+
+        /**
+         * The NIDAQmxDiscontinuity flags of the blocks dropped since the last block posted to the strand.
+         */
+        unsigned int droppedDiscontinuity;
+
+        /**
+         * Rate limiter for the warning on blocks dropped because the strand is full.
+         */
+        nidaqmx::NIDAQmxLogLimiter backlogLogLimiter;
+
+        /* ******* Metrics                                       ******* */
+        /**
+         * The counters reported by the getMetrics rpc command and the metrics endpoint.
+         */
+        NIDAQmxMetrics metrics;
+
+        /**
+         * The loopback HTTP endpoint serving the metrics, or NULL if no [DAQMetrics] port is configured.
+         */
+        NIDAQmxMetricsServer *metricsServer;
+
         /* ****** Debug attributes                              ****** */
         std::string dbgTag;
         
@@ -197,9 +734,155 @@ class NIDAQmxReaderModule : public yarp::os::RFModule {
         virtual bool interruptModule();
         virtual bool close();
 
+        /**
+         * Get the DAQ task parameters, as configured.
+         */
+        const nidaqmx::NIDAQmxTaskParams &getTaskConfig(void) const;
+
+        /**
+         * Get the counters of the module.
+         */
+        const NIDAQmxMetrics &getMetrics(void) const;
+
+        /**
+         * Get the output ports.
+         */
+        const std::vector<NIDAQmxOutput *> &getOutputs(void) const;
+
     private:
         void freeMemory(void);
 
+        /**
+         * Apply the sampling configuration requested over rpc.
+         * This is called by updateModule() so that the DAQ task is only ever touched by the reading thread.
+         */
+        void applySamplingChange(void);
+
+        /**
+         * Handle a failed read: tolerate transient errors up to recoveryTimeouts, otherwise restart the DAQ task.
+         * \returns false if the DAQ task is still not acquiring
+         */
+        bool handleReadFailure(void);
+
+        /**
+         * Restart the failed DAQ task within recoveryBudget and publish the gap once it acquires again.
+         * The blocks read before the failure are processed first, and the stages restart after the gap.
+         * \returns false if the DAQ task could not be recovered, in which case the next updateModule() tries again
+         */
+        bool recoverTask(void);
+
+        /**
+         * Open an output port with the policy configured for it under [DAQOutputs].
+         * \param io_port The output queue
+         * \param i_name The port name
+         * \param i_conf The [DAQOutputs] group
+         * \param i_key The key of the port in the group, holding the policy name and optionally the queue depth
+         * \param i_policy The default policy
+         * \param i_depth The default queue depth
+         * \returns false if the configured policy is invalid or the port cannot be opened
+         */
+        template <class T>
+        bool openOutput(NIDAQmxOutputQueue<T> &io_port, const std::string &i_name, const yarp::os::Bottle &i_conf, const std::string &i_key,
+                const NIDAQmxOutputPolicy &i_policy, const size_t &i_depth);
+
+        /**
+         * Set the envelope of the next message written on a port.
+         * \param io_port The port
+         * \param i_scan The index of the scan the message refers to
+         * \param i_discontinuity The NIDAQmxDiscontinuity flags of the scans missing before it
+         */
+        void setPortEnvelope(NIDAQmxOutput &io_port, const uInt64 &i_scan, const unsigned int &i_discontinuity);
+
+        /**
+         * Find an output port from its key, the port name without the module prefix and suffix.
+         * \param i_key The key, e.g. realBlock
+         * \returns The output port, or NULL if there is none
+         */
+        NIDAQmxOutput *findOutput(const std::string &i_key);
+
+        /**
+         * Connect a reader to an output port listed under [DAQMulticast], with the mcast carrier.
+         * \param i_key The key of the output port
+         * \param i_reader The name of the reader port
+         * \returns false if the port is not multicast or the connection failed
+         */
+        bool connectMulticast(const std::string &i_key, const std::string &i_reader);
+
+        /**
+         * Write a gap marker.
+         * \param i_duration The duration of the gap in seconds
+         */
+        void publishGap(const double &i_duration);
+
+        /**
+         * Calibrate a block if needed, publish it and feed it to the processing stages.
+         * This is called either by updateModule() or by a BlockJob on the module strand, never by both.
+         * \param io_results The block read by the DAQ task
+         * \param i_readTime The time the block was read, i.e. of its last scan
+         */
+        void processResults(nidaqmx::NIDAQmxResults &io_results, const double &i_readTime);
+
+        /**
+         * Create the processing stages for the current sampling rate.
+         */
+        void createStages(void);
+
+        /**
+         * Delete the processing stages.
+         */
+        void deleteStages(void);
+
+        /**
+         * Write the event snapshot collected from the event recorder, if any.
+         */
+        void publishEvent(void);
+
+        /**
+         * Write the window statistics collected from the statistics stage, if any.
+         */
+        void publishStatistics(void);
+
+        /**
+         * Write the band energies collected from the spectrum stage, if any.
+         */
+        void publishSpectrum(void);
+
+        /**
+         * Write the envelope bins collected from a preview envelope, one message per bin stamped with the last scan of the bin.
+         * \param i_envelope The envelope, or NULL if none is configured
+         * \param i_port The port on which the bins are written
+         * \param io_discontinuity The discontinuity flags set on the first bin written, cleared once written
+         */
+        void publishPreview(nidaqmx::NIDAQmxEnvelope *i_envelope, NIDAQmxOutputQueue<yarp::sig::Vector> &i_port, unsigned int &io_discontinuity);
+
+        /**
+         * Parse calibration scales and a row-major calibration matrix.
+         * \param i_scales The calibration scales list
+         * \param i_matrix The calibration matrix list
+         * \param i_nChannels The number of DAQ channels, i.e. the number of matrix columns
+         * \param o_scales The parsed calibration scales
+         * \param o_matrix The parsed calibration matrix, with one row per scale
+         * \returns false if the matrix size does not match the number of scales and channels
+         */
+        bool parseCalibration(const yarp::os::Bottle &i_scales, const yarp::os::Bottle &i_matrix, const size_t &i_nChannels,
+                std::vector<double> &o_scales, nidaqmx::DoubleMatrix2D &o_matrix);
+
+        /**
+         * Compute the range of each real sensor value from the range of the analog channels.
+         * \param i_scales The calibration scales
+         * \param i_matrix The calibration matrix
+         * \param o_min The minimum of each real sensor value
+         * \param o_max The maximum of each real sensor value
+         */
+        void computeQuantiserRanges(const std::vector<double> &i_scales, const nidaqmx::DoubleMatrix2D &i_matrix,
+                std::vector<double> &o_min, std::vector<double> &o_max);
+
+        /**
+         * Replicate the configured sensor on the simulated device: channels, calibration, bias, output transform and event thresholds.
+         * \param i_copies The number of sensors
+         */
+        void replicateSensor(const size_t &i_copies);
+
 };
 
 #endif
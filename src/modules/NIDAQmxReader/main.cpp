@@ -18,19 +18,203 @@
 
 
 
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#elif _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
 #include <yarp/dev/all.h>
 
+#include <NIDAQmxTask/include/NIDAQmxFunctions.h>
+
 #include "NIDAQmxReaderModule.h"
 
 using namespace yarp::os;
 using namespace yarp::dev;
 using namespace yarp::sig;
 
+using nidaqmx::monotonicNow;
+using std::pair;
+using std::string;
+using std::vector;
+
+
+namespace {
+    /**
+     * Reader of an output port during a benchmark, discarding the messages.
+     */
+    class NIDAQmxBenchmarkSink : public PortReader {
+        private:
+            vector<char> buffer;
+
+        public:
+            virtual bool read(ConnectionReader &connection) {
+                size_t size = connection.getSize();
+                if (size == 0) {
+                    return true;
+                }
+
+                buffer.resize(size);
+                return connection.expectBlock(&buffer[0], size);
+            }
+    };
+
+    /**
+     * Get the CPU time used by all the threads of the process, in seconds.
+     */
+    double processCPUTime(void) {
+#ifdef __linux__
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + 1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#elif _WIN32
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+        ULARGE_INTEGER kernel, user;
+        kernel.LowPart = kernelTime.dwLowDateTime;
+        kernel.HighPart = kernelTime.dwHighDateTime;
+        user.LowPart = userTime.dwLowDateTime;
+        user.HighPart = userTime.dwHighDateTime;
+
+        return (kernel.QuadPart + user.QuadPart) * 1e-7;      // 100 ns units
+#endif
+    }
+
+
+    /**
+     * Sum the metrics whose name starts with the given prefix, e.g. a labelled metric over all its labels.
+     */
+    double sumMetrics(const vector<pair<string, double> > &i_metrics, const string &i_prefix) {
+        double sum = 0;
+        for (size_t i = 0; i < i_metrics.size(); ++i) {
+            if (i_metrics[i].first.compare(0, i_prefix.size(), i_prefix) == 0) {
+                sum += i_metrics[i].second;
+            }
+        }
+
+        return sum;
+    }
+
+    /**
+     * Run the configured pipeline against the simulated device for a fixed duration and report its performance.
+     * The module is driven like runModule() would, calling updateModule() once per period.
+     */
+    int runBenchmark(NIDAQmxReaderModule &io_module, ResourceFinder &rf) {
+        double duration = rf.check("duration", Value(10.0), "The benchmark duration in seconds.").asDouble();
+        if (duration <= 0) {
+            fprintf(stdout, "Error: The benchmark duration must be positive.\n");
+            return -1;
+        }
+        if (!io_module.configure(rf)) {
+            fprintf(stdout, "Error: Could not configure the module for the benchmark.\n");
+            return -1;
+        }
+
+        // A block is only processed for the ports having a reader
+        const vector<NIDAQmxOutput *> &outputs = io_module.getOutputs();
+        vector<NIDAQmxBenchmarkSink *> sinkReaders;
+        vector<Port *> sinks;
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            char sinkName[64];
+            snprintf(sinkName, sizeof(sinkName), "/NIDAQmxReader/benchmark/sink%d:i", (int) i);
+            sinkReaders.push_back(new NIDAQmxBenchmarkSink());
+            sinks.push_back(new Port());
+            sinks[i]->setReader(*sinkReaders[i]);
+            if (!sinks[i]->open(sinkName) || !Network::connect(outputs[i]->getName().c_str(), sinkName)) {
+                fprintf(stdout, "Warning: Could not read %s during the benchmark.\n", outputs[i]->getName().c_str());
+            }
+        }
+
+        const NIDAQmxMetrics &metrics = io_module.getMetrics();
+        vector<pair<string, double> > before, after;
+        metrics.collect(outputs, before);
+        double period = io_module.getPeriod();
+        double cpuStart = processCPUTime();
+        double start = monotonicNow();
+        double elapsed = 0;
+        while (elapsed < duration) {
+            double updateStart = monotonicNow();
+            io_module.updateModule();
+
+            double wait = period - (monotonicNow() - updateStart);
+            if (wait > 0) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+            }
+            elapsed = monotonicNow() - start;
+        }
+        double cpuTime = processCPUTime() - cpuStart;
+        metrics.collect(outputs, after);
+
+        // Report
+        const nidaqmx::NIDAQmxTaskParams &taskConfig = io_module.getTaskConfig();
+        double scans = sumMetrics(after, "nidaqmx_scans_read_total") - sumMetrics(before, "nidaqmx_scans_read_total");
+        double messages = sumMetrics(after, "nidaqmx_port_messages_total") - sumMetrics(before, "nidaqmx_port_messages_total");
+        double bytes = sumMetrics(after, "nidaqmx_port_bytes_total") - sumMetrics(before, "nidaqmx_port_bytes_total");
+
+        fprintf(stdout, "\nNIDAQmxReader benchmark: %d channels at %g Hz, %d scans per block, period %g s, %g s.\n",
+                (int) taskConfig.DAQChannels.size(), taskConfig.DAQSamplingRate, taskConfig.DAQSamplesPerChannel, period, elapsed);
+        fprintf(stdout, "Throughput: %.1f scans/s sustained, %.1f%% of the sampling rate.\n", scans / elapsed,
+                100.0 * scans / (elapsed * taskConfig.DAQSamplingRate));
+        fprintf(stdout, "    Blocks read %.0f, published %.0f, at most %.0f waiting to be processed.\n",
+                sumMetrics(after, "nidaqmx_blocks_read_total") - sumMetrics(before, "nidaqmx_blocks_read_total"),
+                sumMetrics(after, "nidaqmx_blocks_published_total") - sumMetrics(before, "nidaqmx_blocks_published_total"),
+                sumMetrics(after, "nidaqmx_backlog_blocks_max"));
+        fprintf(stdout, "    Driver errors %.0f, overruns %.0f, recoveries %.0f.\n",
+                sumMetrics(after, "nidaqmx_driver_errors_total") - sumMetrics(before, "nidaqmx_driver_errors_total"),
+                sumMetrics(after, "nidaqmx_overruns_total") - sumMetrics(before, "nidaqmx_overruns_total"),
+                sumMetrics(after, "nidaqmx_recoveries_total") - sumMetrics(before, "nidaqmx_recoveries_total"));
+        fprintf(stdout, "    Ports written %.1f messages/s, %.3f MB/s, %.0f messages dropped.\n", messages / elapsed, bytes / elapsed * 1e-6,
+                sumMetrics(after, "nidaqmx_port_dropped_total") - sumMetrics(before, "nidaqmx_port_dropped_total"));
+
+        fprintf(stdout, "Time spent by a block in each phase, p50 / p90 / p99 in microseconds:\n");
+        for (int i = 0; i < NIDAQmxMetrics::NPhases; ++i) {
+            NIDAQmxMetrics::Phase phase = (NIDAQmxMetrics::Phase) i;
+            if (metrics.getPhaseCount(phase) > 0) {
+                fprintf(stdout, "    %-12s %10.1f / %10.1f / %10.1f  (%llu blocks)\n", NIDAQmxMetrics::getPhaseName(phase),
+                        metrics.getPhaseLatency(phase, 0.5) * 1e6, metrics.getPhaseLatency(phase, 0.9) * 1e6,
+                        metrics.getPhaseLatency(phase, 0.99) * 1e6, (unsigned long long) metrics.getPhaseCount(phase));
+            }
+        }
+        fprintf(stdout, "CPU: %.2f s over %.2f s, %.1f%% of one core.\n\n", cpuTime, elapsed, 100.0 * cpuTime / elapsed);
+        fflush(stdout);
+
+        io_module.close();
+        for (size_t i = 0; i < sinks.size(); ++i) {
+            sinks[i]->close();
+            delete sinks[i];
+            delete sinkReaders[i];
+        }
+
+        return 0;
+    }
+}
+
 
 int main(int argc, char *argv[]) {
+    // The benchmark runs against the simulated device, with the ports registered within the process
+    bool benchmark = false;
+    for (int i = 1; i < argc; ++i) {
+        benchmark = benchmark || (strcmp(argv[i], "--benchmark") == 0);
+    }
+
     // Open network
     Network yarp;
-    if (!yarp.checkNetwork()) {
+    if (benchmark) {
+        Network::setLocalMode(true);
+    } else if (!yarp.checkNetwork()) {
          fprintf(stdout, "Error: yarp server is not available.\n");
          return -1;
     }     
@@ -39,11 +223,20 @@ int main(int argc, char *argv[]) {
     NIDAQmxReaderModule mod;
 
     // Create resource finder
+    static char simulateOption[] = "--simulate";
+    vector<char *> args(argv, argv + argc);
+    if (benchmark) {
+        args.push_back(simulateOption);
+    }
     ResourceFinder rf;
     rf.setVerbose();
     rf.setDefaultConfigFile("confNIDAQmxReader.ini");
     rf.setDefaultContext("NIDAQmxReader");
-    rf.configure("ICUB_ROOT", argc, argv);
+    rf.configure("ICUB_ROOT", (int) args.size(), &args[0]);
+
+    if (benchmark) {
+        return runBenchmark(mod, rf);
+    }
 
     // Configure and run module
     mod.runModule(rf);